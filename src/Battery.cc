@@ -102,6 +102,10 @@ auto Battery::get_property(std::string_view name) const noexcept -> std::string_
 
     return {value, static_cast<std::size_t>(end - value)};
 }
+auto Battery::get_uevent() const noexcept -> std::string_view
+{
+    return buffer;
+}
 } /* namespace swaystatus */
 
 using Batteries_formatter = fmt::formatter<std::vector<swaystatus::Battery>>;
@@ -39,6 +39,10 @@ public:
     void read_battery_uevent();
 
     auto get_property(std::string_view name) const noexcept -> std::string_view;
+    /**
+     * @return content of uevent read by the last call to read_battery_uevent()
+     */
+    auto get_uevent() const noexcept -> std::string_view;
 };
 
 class Batteries {
@@ -21,7 +21,31 @@ static const char *get_str_from_config(
     return json_object_get_string(val);
 }
 
-Callable_base::Callable_base(const char *name, const void *callable_config_arg)
+CallableInterpreter::CallableInterpreter(bool isolated) noexcept:
+    isolated{isolated}
+{}
+
+#ifdef USE_PYTHON
+auto CallableInterpreter::get() -> python::Interpreter&
+{
+    if (interpreter == nullptr) {
+        if (isolated) {
+            auto scope = python::MainInterpreter::get().acquire();
+            // Never freed, just like the callables loaded into it.
+            interpreter = new python::SubInterpreter{};
+        } else
+            interpreter = &python::MainInterpreter::get();
+    }
+
+    return *interpreter;
+}
+#endif
+
+Callable_base::Callable_base(
+    const char *name,
+    const void *callable_config_arg,
+    CallableInterpreter *callable_interpreter
+)
 {
     auto *callable_config = static_cast<const json_object*>(callable_config_arg);
     const char *type = get_str_from_config(name, callable_config, "type");
@@ -37,7 +61,10 @@ Callable_base::Callable_base(const char *name, const void *callable_config_arg)
     if (std::strcmp(type, "python") == 0) {
 #ifdef USE_PYTHON
         python::MainInterpreter::load_libpython3();
-        auto scope = python::MainInterpreter::get().acquire();
+
+        CallableInterpreter main_interpreter;
+        interpreter = &(callable_interpreter ? callable_interpreter : &main_interpreter)->get();
+        auto scope = interpreter->acquire();
 
         auto module = [&]{
             struct json_object *code;
@@ -50,6 +77,7 @@ Callable_base::Callable_base(const char *name, const void *callable_config_arg)
 
         v.emplace<python::Callable_base>(module.getattr(function_name));
 #else
+        (void) callable_interpreter;
         errx(1, "Click events specified using python callback, but feature python is not "
                 "supported.");
 #endif
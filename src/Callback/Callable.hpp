@@ -3,6 +3,7 @@
 
 # include <err.h>
 
+# include <utility>
 # include <variant>
 
 # include "../utility.h"
@@ -37,6 +38,30 @@ constexpr bool is_valid_callable_args() noexcept
 }
 } /* namespace impl */
 
+/**
+ * Interpreter the python callables of one block are loaded into.
+ */
+class CallableInterpreter {
+# ifdef USE_PYTHON
+    python::Interpreter *interpreter = nullptr;
+# endif
+    bool isolated;
+
+public:
+    /**
+     * @param isolated if set, python callables are loaded into a SubInterpreter created on the
+     *                 first use instead of the main interpreter.
+     */
+    explicit CallableInterpreter(bool isolated = false) noexcept;
+
+# ifdef USE_PYTHON
+    /**
+     * @pre load_libpython3() has been called and the calling thread does not hold any GIL.
+     */
+    auto get() -> python::Interpreter&;
+# endif
+};
+
 class Callable_base {
     std::variant<
         std::monostate,
@@ -47,13 +72,24 @@ class Callable_base {
 # endif
     > v;
 
+# ifdef USE_PYTHON
+    python::Interpreter *interpreter = nullptr;
+# endif
+
     template <class Ret, class ...Args>
     friend class Callable;
 
 public:
     Callable_base() = default;
 
-    Callable_base(const char *name, const void *callable_config);
+    /**
+     * @param interpreter if nullptr, the main interpreter is used.
+     */
+    Callable_base(
+        const char *name,
+        const void *callable_config,
+        CallableInterpreter *interpreter = nullptr
+    );
 
     Callable_base(Callable_base&&) = default;
     Callable_base& operator = (Callable_base&&) = default;
@@ -96,6 +132,41 @@ class Callable {
 # endif
     > v;
 
+# ifdef USE_PYTHON
+    python::Interpreter *interpreter = nullptr;
+# endif
+
+    auto call(Args ...args) -> Ret
+    {
+        if constexpr(std::is_void_v<Ret>) {
+            std::visit([&](auto &&f) {
+                f(std::forward<Args>(args)...);
+            }, v);
+        } else {
+            return std::visit([&](auto &&f)
+            {
+                return f(std::forward<Args>(args)...);
+            }, v);
+        }
+    }
+
+# ifdef USE_PYTHON
+    /**
+     * Call f with the GIL of interpreter held.
+     */
+    template <class F>
+    auto with_gil(F &&f) -> decltype(f())
+    {
+        if (!python::Interpreter::is_on_main_thread()) {
+            auto scope = interpreter->acquire_on_current_thread();
+            return f();
+        }
+
+        auto scope = interpreter->acquire();
+        return f();
+    }
+# endif
+
 public:
     Callable() = default;
 
@@ -104,6 +175,7 @@ public:
 # ifdef USE_PYTHON
         if (auto p = std::get_if<python::Callable_base>(&base.v); p) {
             v.template emplace<py_callback>(std::move(*p));
+            interpreter = base.interpreter;
         } else
 # endif
         if (auto p = std::get_if<void*>(&base.v); p) {
@@ -116,24 +188,50 @@ public:
 
     ~Callable() = default;
 
+# ifdef USE_PYTHON
+    /**
+     * @return the python callable held, or nullptr if it is not a python callable.
+     */
+    auto get_python_callable() noexcept -> python::Callable_base*
+    {
+        return std::get_if<py_callback>(&v);
+    }
+    /**
+     * @return the interpreter the python callable is loaded into, or nullptr if it is not a
+     *         python callable.
+     */
+    auto get_python_interpreter() noexcept -> python::Interpreter*
+    {
+        return interpreter;
+    }
+
+    /**
+     * Call f with the python callable and the GIL held, so that f can call it with python
+     * objects other than Args and use views into the result instead of copying it.
+     *
+     * Can be called on any thread, but not concurrently.
+     *
+     * @pre get_python_callable() != nullptr
+     */
+    template <class F>
+    auto with_python_callable(F &&f) -> decltype(f(std::declval<python::Callable_base&>()))
+    {
+        auto &callable = static_cast<python::Callable_base&>(std::get<py_callback>(v));
+        return with_gil([&]{ return f(callable); });
+    }
+# endif
+
+    /**
+     * Can be called on any thread, but not concurrently.
+     */
     auto operator () (Args ...args) -> Ret
     {
 # ifdef USE_PYTHON
-        auto scope = std::holds_alternative<py_callback>(v) ? 
-            python::MainInterpreter::get().acquire() :
-            python::Interpreter::GIL_scoped(nullptr);
+        if (std::holds_alternative<py_callback>(v))
+            return with_gil([&]{ return call(std::forward<Args>(args)...); });
 # endif
 
-        if constexpr(std::is_void_v<Ret>) {
-            std::visit([&](auto &&f) {
-                f(std::forward<Args>(args)...);
-            }, v);
-        } else {
-            return std::visit([&](auto &&f)
-            {
-                return f(std::forward<Args>(args)...);
-            }, v);
-        }
+        return call(std::forward<Args>(args)...);
     }
 };
 } /* namespace swaystatus */
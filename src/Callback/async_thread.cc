@@ -0,0 +1,46 @@
+#include "../poller.h"
+
+#include "async_thread.hpp"
+
+namespace swaystatus {
+/**
+ * It is never freed since jobs might be stuck forever, see WorkerPool.
+ */
+static WorkerPool *async_thread;
+static bool is_done;
+static void notify_done(void *data)
+{
+    (void) data;
+    async_thread->notify();
+}
+
+static void on_notification(int fd, enum Event events, void *data)
+{
+    (void) fd;
+    (void) events;
+    (void) data;
+
+    async_thread->consume_notification();
+    is_done = true;
+}
+
+void submit_async(WorkerPool::Job job, void *data)
+{
+    if (!async_thread) {
+        async_thread = new WorkerPool{1};
+
+        request_polling(async_thread->get_notification_fd(), read_ready, on_notification, nullptr);
+    }
+
+    async_thread->submit(job, data);
+    // There is only one thread, so it is run right after job is done.
+    async_thread->submit(notify_done, nullptr);
+}
+
+bool consume_async_done() noexcept
+{
+    bool done = is_done;
+    is_done = false;
+    return done;
+}
+} /* namespace swaystatus */
@@ -0,0 +1,25 @@
+#ifndef  __swaystatus_async_thread_HPP__
+# define __swaystatus_async_thread_HPP__
+
+# include "../worker_pool.hpp"
+
+namespace swaystatus {
+/**
+ * Run job on the thread dedicated to callbacks called asynchronously, which is started on
+ * the first call.
+ *
+ * Jobs are run one at a time in the order they are submitted, so callbacks never run
+ * concurrently with each other.
+ * Once a job is done, the main thread is woken up and consume_async_done() returns true.
+ */
+void submit_async(WorkerPool::Job job, void *data);
+
+/**
+ * Called by the main thread.
+ *
+ * @return true if any job is done since the last call.
+ */
+bool consume_async_done() noexcept;
+} /* namespace swaystatus */
+
+#endif
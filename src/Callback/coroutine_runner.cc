@@ -0,0 +1,103 @@
+#ifdef USE_PYTHON
+
+# include <err.h>
+# include <time.h>
+# include <sys/timerfd.h>
+
+# include <utility>
+
+# include "../utility.h"
+# include "coroutine_runner.hpp"
+
+namespace swaystatus::python {
+CoroutineRunner::CoroutineRunner(Callback on_done, void *on_done_data) noexcept:
+    on_done{on_done},
+    on_done_data{on_done_data}
+{}
+
+CoroutineRunner::~CoroutineRunner()
+{
+    if (polled_fd != -1)
+        cancel_polling(polled_fd);
+}
+
+bool CoroutineRunner::is_running() const noexcept
+{
+    return coroutine.has_value();
+}
+
+void CoroutineRunner::arm_timer(std::uint64_t timeout)
+{
+    if (!timer_fd) {
+        timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (!timer_fd)
+            err(1, "%s failed", "timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)");
+    }
+
+    struct itimerspec spec = {};
+    spec.it_value.tv_sec = timeout / 1000;
+    spec.it_value.tv_nsec = (timeout % 1000) * 1000 * 1000;
+    // it_value of 0 disarms the timer.
+    if (timeout == 0)
+        spec.it_value.tv_nsec = 1;
+
+    if (timerfd_settime(timer_fd.get(), 0, &spec, nullptr) == -1)
+        err(1, "%s failed", "timerfd_settime");
+}
+
+bool CoroutineRunner::step()
+{
+    Coroutine::Request request;
+    if (!coroutine.resume(request)) {
+        coroutine = Coroutine{Object{}};
+        return true;
+    }
+
+    if (request.fd == -1) {
+        arm_timer(request.timeout);
+        polled_fd = timer_fd.get();
+    } else
+        polled_fd = request.fd;
+
+    request_polling(polled_fd, read_ready, on_ready, this);
+
+    return false;
+}
+
+void CoroutineRunner::on_ready(int fd, enum Event events, void *data)
+{
+    (void) events;
+
+    auto *self = static_cast<CoroutineRunner*>(data);
+
+    // Each await polls the fd once.
+    cancel_polling(fd);
+    self->polled_fd = -1;
+    if (self->timer_fd && fd == self->timer_fd.get())
+        read_timer(fd);
+
+    bool is_done;
+    {
+        auto scope = self->interpreter->acquire();
+        is_done = self->step();
+    }
+
+    if (is_done)
+        self->on_done(self->on_done_data);
+}
+
+void CoroutineRunner::start(Object &&obj, Interpreter &interpreter)
+{
+    if (obj.is_none())
+        return;
+
+    if (!Coroutine::check(obj))
+        errx(1, "Callback returns neither None nor a coroutine");
+
+    coroutine = Coroutine{std::move(obj)};
+    this->interpreter = &interpreter;
+    step();
+}
+} /* namespace swaystatus::python */
+
+#endif /* USE_PYTHON */
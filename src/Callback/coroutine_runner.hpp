@@ -0,0 +1,73 @@
+#ifndef  __swaystatus_coroutine_runner_HPP__
+# define __swaystatus_coroutine_runner_HPP__
+
+# ifdef USE_PYTHON
+
+#  include "../Fd.hpp"
+#  include "../poller.h"
+#  include "python3.hpp"
+
+namespace swaystatus::python {
+/**
+ * CoroutineRunner drives one Coroutine at a time with the poller: whenever it awaits an fd or
+ * a timeout, the fd is polled and the coroutine is resumed once it is ready.
+ */
+class CoroutineRunner {
+public:
+    using Callback = void (*)(void *data);
+
+private:
+    Coroutine coroutine{Object{}};
+    /**
+     * Interpreter the coroutine is created in
+     */
+    Interpreter *interpreter = nullptr;
+
+    /**
+     * Lazily created one-shot timerfd for sleep()
+     */
+    Fd timer_fd;
+    int polled_fd = -1;
+
+    Callback on_done;
+    void *on_done_data;
+
+    static void on_ready(int fd, enum Event events, void *data);
+
+    /**
+     * @pre the GIL is held
+     * @return true if the coroutine returns.
+     */
+    bool step();
+    void arm_timer(std::uint64_t timeout);
+
+public:
+    /**
+     * @param on_done called once a coroutine returns after awaiting, not called if it returns
+     *                within start().
+     */
+    CoroutineRunner(Callback on_done, void *on_done_data) noexcept;
+
+    CoroutineRunner(const CoroutineRunner&) = delete;
+    CoroutineRunner& operator = (const CoroutineRunner&) = delete;
+
+    ~CoroutineRunner();
+
+    /**
+     * @return true if a coroutine is waiting.
+     */
+    bool is_running() const noexcept;
+
+    /**
+     * Run obj until it awaits or returns.
+     *
+     * @pre the GIL of interpreter is held and !is_running()
+     * @param obj can be None, which is ignored, or a coroutine created in interpreter.
+     */
+    void start(Object &&obj, Interpreter &interpreter);
+};
+} /* namespace swaystatus::python */
+
+# endif /* USE_PYTHON */
+
+#endif
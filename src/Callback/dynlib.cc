@@ -1,27 +1,49 @@
 #include <dlfcn.h>
 
 #include <err.h>
+#include <stdlib.h> /* For getenv */
 
 #include "../utility.h"
 #include "dynlib.hpp"
 
 #include <array>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 std::array<std::string, 2> dlpaths;
 
 extern "C" {
-void setup_dlpath(const char *path)
+static constexpr const char *cwd_env = "SWAYSTATUS_DLPATH_CWD";
+
+void setup_dlpath(const char *path, bool is_reload)
 {
-    dlpaths[0] = swaystatus::getcwd_checked();
+    const char *cwd = is_reload ? getenv(cwd_env) : nullptr;
+    if (cwd)
+        dlpaths[0] = cwd;
+    else {
+        dlpaths[0] = swaystatus::getcwd_checked();
+        setenv_checked(cwd_env, dlpaths[0].c_str(), 1);
+    }
     dlpaths[0].shrink_to_fit();
 
     if (path)
         dlpaths[1] = path;
 }
 
-void* dload_symbol(const char *filename, const char *symbol_name)
+/**
+ * Handles of libraries opened by dload_library, which are never closed.
+ */
+static std::vector<std::pair<std::string, void*>> handles;
+
+void* dload_library(const char *filename)
 {
+    for (const auto &[name, handle]: handles) {
+        if (name == filename)
+            return handle;
+    }
+
     /* Clear any previous error */
     dlerror();
 
@@ -41,9 +63,20 @@ void* dload_symbol(const char *filename, const char *symbol_name)
                 break;
         }
         if (handle == nullptr)
-            errx(1, "%s on %s failed: %s", "dload_symbol", filename, dlerror());
+            errx(1, "%s on %s failed: %s", "dload_library", filename, dlerror());
     }
 
+    handles.emplace_back(filename, handle);
+    return handle;
+}
+
+void* dload_symbol(const char *filename, const char *symbol_name)
+{
+    void *handle = dload_library(filename);
+
+    /* Clear any previous error */
+    dlerror();
+
      void *sym = dlsym(handle, symbol_name);
      const char *error = dlerror();
      if (sym == nullptr) {
@@ -1,16 +1,27 @@
 #ifndef  __swaystatus_dylib_HPP__
 # define __swaystatus_dylib_HPP__
 
+# include <stdbool.h>
+
 # ifdef __cplusplus
 extern "C" {
 # endif
 
 /**
  * @param path can be NULL
+ * @param is_reload if true, the working directory at the first start is used, which is
+ *                  passed across exec in environment variable SWAYSTATUS_DLPATH_CWD.
  *
  * setup_dlpath should be called before chdir is called.
  */
-void setup_dlpath(const char *path);
+void setup_dlpath(const char *path, bool is_reload);
+
+/**
+ * Each library is only opened once and never closed, not thread safe.
+ *
+ * @param filename searched in the default paths of dlopen, then those passed to setup_dlpath
+ */
+void* dload_library(const char *filename);
 
 void* dload_symbol(const char *filename, const char *symbol_name);
 
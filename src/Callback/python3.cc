@@ -4,13 +4,44 @@
 # include <cstdarg>
 # include <cstdlib>
 # include <memory>
+# include <thread>
 
 # include <err.h>
+# include <dlfcn.h>
+
+/*
+ * libpython is not linked, but loaded by dlopen in MainInterpreter::load_libpython3(), so
+ * that swaystatus pays nothing for it unless python is used in the config.
+ *
+ * Every symbol of libpython used here is resolved into a pointer py3_<name> when it is
+ * loaded and its name is redirected to the pointer with a macro.
+ *
+ * Objects and _Py_Dealloc are also referenced by inline functions of Python.h, so they are
+ * redirected before including it, which turns their declarations into ones of the pointers.
+ */
+# include <patchlevel.h>
+
+# if PY_VERSION_HEX < 0x03090000
+#  error "Minimum python3 version is 3.9"
+# endif
+
+# define PyBool_Type (*py3_PyBool_Type)
+# define PyCoro_Type (*py3_PyCoro_Type)
+# define PyLong_Type (*py3_PyLong_Type)
+# define PyExc_BufferError (*py3_PyExc_BufferError)
+# define PyExc_KeyError (*py3_PyExc_KeyError)
+# define PyExc_StopIteration (*py3_PyExc_StopIteration)
+# define _Py_NoneStruct (*py3__Py_NoneStruct)
+# define _Py_Dealloc (*py3__Py_Dealloc)
 
 # define PY_SSIZE_T_CLEAN
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wparentheses"
 # include <Python.h>
+# pragma GCC diagnostic pop
 
 # include "../utility.h"
+# include "../native_views.hpp"
 # include "python3.hpp"
 
 /*
@@ -25,6 +56,197 @@
  * https://stackoverflow.com/questions/29595222/multithreading-with-python-and-c-api
  */
 
+# define PYTHON3_OBJECTS(X)  \
+    X(PyBool_Type)          \
+    X(PyCoro_Type)          \
+    X(PyLong_Type)          \
+    X(PyExc_BufferError)    \
+    X(PyExc_KeyError)       \
+    X(PyExc_StopIteration)  \
+    X(_Py_NoneStruct)
+
+/*
+ * Python.h declares _Py_Dealloc without extern, which turns into the definition of the
+ * pointer.
+ */
+# define PYTHON3_DEALLOC_FUNCTIONS(X) \
+    X(_Py_Dealloc)
+
+/* PyCFunction_NewEx is a macro of PyCMethod_New */
+# define PYTHON3_CALL_FUNCTIONS(X)  \
+    X(PyCMethod_New)                \
+    X(PyThreadState_GetInterpreter)
+
+/*
+ * PyObject_Vectorcall is a static inline function of the headers in 3.9 and 3.10, which
+ * calls private functions of libpython, so PyObject_Call is used before 3.11.
+ */
+# if PY_VERSION_HEX >= 0x030B0000
+#  define PYTHON3_VECTORCALL_FUNCTIONS(X)   \
+    X(PyObject_Vectorcall)
+# else
+#  define PYTHON3_VECTORCALL_FUNCTIONS(X)   \
+    X(PyObject_Call)                        \
+    X(PyTuple_New)
+# endif
+
+# if PY_VERSION_HEX >= 0x030C0000
+#  define PYTHON3_INTERPRETER_FUNCTIONS(X)  \
+    X(Py_NewInterpreterFromConfig)          \
+    X(PyStatus_Exception)
+# else
+#  define PYTHON3_INTERPRETER_FUNCTIONS(X)  \
+    X(Py_NewInterpreter)
+# endif
+
+/*
+ * PyObject_CallMethod is a macro of _PyObject_CallMethod_SizeT before 3.13 if
+ * PY_SSIZE_T_CLEAN is defined.
+ */
+# if PY_VERSION_HEX >= 0x030D0000
+#  define PYTHON3_CALL_METHOD_FUNCTIONS(X)  \
+    X(PyObject_CallMethod)
+# else
+#  define PYTHON3_CALL_METHOD_FUNCTIONS(X)  \
+    X(_PyObject_CallMethod_SizeT)
+# endif
+
+# define PYTHON3_FUNCTIONS(X)           \
+    PYTHON3_CALL_FUNCTIONS(X)           \
+    PYTHON3_VECTORCALL_FUNCTIONS(X)     \
+    PYTHON3_INTERPRETER_FUNCTIONS(X)    \
+    PYTHON3_CALL_METHOD_FUNCTIONS(X)    \
+    X(PyCallable_Check)                 \
+    X(PyConfig_InitPythonConfig)        \
+    X(PyConfig_SetArgv)                 \
+    X(PyErr_Clear)                      \
+    X(PyErr_ExceptionMatches)           \
+    X(PyErr_Format)                     \
+    X(PyErr_Occurred)                   \
+    X(PyErr_PrintEx)                    \
+    X(PyErr_SetString)                  \
+    X(PyEval_AcquireThread)             \
+    X(PyEval_RestoreThread)             \
+    X(PyEval_SaveThread)                \
+    X(PyImport_ExecCodeModule)          \
+    X(PyImport_ImportModule)            \
+    X(PyInterpreterState_Main)          \
+    X(PyLong_AsSize_t)                  \
+    X(PyLong_AsSsize_t)                 \
+    X(PyLong_FromSize_t)                \
+    X(PyLong_FromSsize_t)               \
+    X(PyMem_RawFree)                    \
+    X(PyMemoryView_FromMemory)          \
+    X(PyModule_GetName)                 \
+    X(PyObject_GetAttrString)           \
+    X(PyObject_HasAttrString)           \
+    X(PyObject_IsTrue)                  \
+    X(PyObject_SetAttrString)           \
+    X(PyThreadState_Clear)              \
+    X(PyThreadState_DeleteCurrent)      \
+    X(PyThreadState_Get)                \
+    X(PyThreadState_New)                \
+    X(PyTuple_GetItem)                  \
+    X(PyTuple_Pack)                     \
+    X(PyType_FromSpec)                  \
+    X(PyUnicode_AsUTF8AndSize)          \
+    X(PyUnicode_DecodeUTF8)             \
+    X(Py_CompileStringExFlags)          \
+    X(Py_DecodeLocale)                  \
+    X(Py_EndInterpreter)                \
+    X(Py_InitializeEx)                  \
+    X(Py_IsInitialized)
+
+/* Pointers to objects are declared by Python.h */
+# define DEFINE_PYTHON3_OBJECT(name) decltype(py3_##name) py3_##name;
+PYTHON3_OBJECTS(DEFINE_PYTHON3_OBJECT)
+# undef DEFINE_PYTHON3_OBJECT
+
+# define DEFINE_PYTHON3_FUNCTION(name) static decltype(&::name) py3_##name;
+PYTHON3_FUNCTIONS(DEFINE_PYTHON3_FUNCTION)
+# undef DEFINE_PYTHON3_FUNCTION
+
+# define PyCMethod_New (*py3_PyCMethod_New)
+# define PyThreadState_GetInterpreter (*py3_PyThreadState_GetInterpreter)
+# if PY_VERSION_HEX >= 0x030B0000
+#  define PyObject_Vectorcall (*py3_PyObject_Vectorcall)
+# else
+#  define PyObject_Call (*py3_PyObject_Call)
+#  define PyTuple_New (*py3_PyTuple_New)
+# endif
+# if PY_VERSION_HEX >= 0x030C0000
+#  define Py_NewInterpreterFromConfig (*py3_Py_NewInterpreterFromConfig)
+#  define PyStatus_Exception (*py3_PyStatus_Exception)
+# else
+#  define Py_NewInterpreter (*py3_Py_NewInterpreter)
+# endif
+# if PY_VERSION_HEX >= 0x030D0000
+#  define PyObject_CallMethod (*py3_PyObject_CallMethod)
+# else
+#  define _PyObject_CallMethod_SizeT (*py3__PyObject_CallMethod_SizeT)
+# endif
+# define PyCallable_Check (*py3_PyCallable_Check)
+# define PyConfig_InitPythonConfig (*py3_PyConfig_InitPythonConfig)
+# define PyConfig_SetArgv (*py3_PyConfig_SetArgv)
+# define PyErr_Clear (*py3_PyErr_Clear)
+# define PyErr_ExceptionMatches (*py3_PyErr_ExceptionMatches)
+# define PyErr_Format (*py3_PyErr_Format)
+# define PyErr_Occurred (*py3_PyErr_Occurred)
+# define PyErr_PrintEx (*py3_PyErr_PrintEx)
+# define PyErr_SetString (*py3_PyErr_SetString)
+# define PyEval_AcquireThread (*py3_PyEval_AcquireThread)
+# define PyEval_RestoreThread (*py3_PyEval_RestoreThread)
+# define PyEval_SaveThread (*py3_PyEval_SaveThread)
+# define PyImport_ExecCodeModule (*py3_PyImport_ExecCodeModule)
+# define PyImport_ImportModule (*py3_PyImport_ImportModule)
+# define PyInterpreterState_Main (*py3_PyInterpreterState_Main)
+# define PyLong_AsSize_t (*py3_PyLong_AsSize_t)
+# define PyLong_AsSsize_t (*py3_PyLong_AsSsize_t)
+# define PyLong_FromSize_t (*py3_PyLong_FromSize_t)
+# define PyLong_FromSsize_t (*py3_PyLong_FromSsize_t)
+# define PyMem_RawFree (*py3_PyMem_RawFree)
+# define PyMemoryView_FromMemory (*py3_PyMemoryView_FromMemory)
+# define PyModule_GetName (*py3_PyModule_GetName)
+# define PyObject_GetAttrString (*py3_PyObject_GetAttrString)
+# define PyObject_HasAttrString (*py3_PyObject_HasAttrString)
+# define PyObject_IsTrue (*py3_PyObject_IsTrue)
+# define PyObject_SetAttrString (*py3_PyObject_SetAttrString)
+# define PyThreadState_Clear (*py3_PyThreadState_Clear)
+# define PyThreadState_DeleteCurrent (*py3_PyThreadState_DeleteCurrent)
+# define PyThreadState_Get (*py3_PyThreadState_Get)
+# define PyThreadState_New (*py3_PyThreadState_New)
+# define PyTuple_GetItem (*py3_PyTuple_GetItem)
+# define PyTuple_Pack (*py3_PyTuple_Pack)
+# define PyType_FromSpec (*py3_PyType_FromSpec)
+# define PyUnicode_AsUTF8AndSize (*py3_PyUnicode_AsUTF8AndSize)
+# define PyUnicode_DecodeUTF8 (*py3_PyUnicode_DecodeUTF8)
+# define Py_CompileStringExFlags (*py3_Py_CompileStringExFlags)
+# define Py_DecodeLocale (*py3_Py_DecodeLocale)
+# define Py_EndInterpreter (*py3_Py_EndInterpreter)
+# define Py_InitializeEx (*py3_Py_InitializeEx)
+# define Py_IsInitialized (*py3_Py_IsInitialized)
+
+static void *libpython3;
+
+/**
+ * Load libpython with RTLD_GLOBAL, since C extension modules expect to find its symbols.
+ */
+static void dlopen_libpython3()
+{
+    libpython3 = dlopen(LIBPYTHON3_SONAME, RTLD_NOW | RTLD_GLOBAL);
+    if (libpython3 == nullptr)
+        errx(1, "%s on %s failed: %s", "dlopen", LIBPYTHON3_SONAME, dlerror());
+
+# define LOAD_PYTHON3_SYMBOL(name)                                                  \
+    py3_##name = reinterpret_cast<decltype(py3_##name)>(dlsym(libpython3, #name));  \
+    if (py3_##name == nullptr)                                                      \
+        errx(1, "%s on %s failed: %s", "dlsym", #name, dlerror());
+    PYTHON3_OBJECTS(LOAD_PYTHON3_SYMBOL)
+    PYTHON3_DEALLOC_FUNCTIONS(LOAD_PYTHON3_SYMBOL)
+    PYTHON3_FUNCTIONS(LOAD_PYTHON3_SYMBOL)
+# undef LOAD_PYTHON3_SYMBOL
+}
+
 extern "C" {
 void setup_pythonpath(const char *path)
 {
@@ -95,8 +317,34 @@ static void Py_Err(const char *fmt, ...)
 }
 
 namespace swaystatus::python {
+static std::thread::id main_thread_id;
+
+static bool is_batching;
+/**
+ * Interpreter kept acquired by Batch_scoped
+ */
+static Interpreter *batched;
+
+static PyObject* getPyObject(Object &o)
+{
+    return static_cast<PyObject*>(o.get());
+}
+static PyObject* getPyObject(const Object &o)
+{
+    return static_cast<PyObject*>(const_cast<void*>(o.get()));
+}
+
+static void* get_interpreter_state(void *tstate) noexcept
+{
+    if (tstate == nullptr)
+        return nullptr;
+
+    return PyThreadState_GetInterpreter(static_cast<PyThreadState*>(tstate));
+}
+
 Interpreter::Interpreter(void *p) noexcept:
-    p{p}
+    p{p},
+    state{get_interpreter_state(p)}
 {}
 
 Interpreter::GIL_scoped::GIL_scoped(Interpreter *interpreter) noexcept:
@@ -112,8 +360,18 @@ auto Interpreter::acquire() -> GIL_scoped
     if (p == nullptr)
         return GIL_scoped{nullptr};
 
+    if (batched) {
+        batched->release();
+        batched = nullptr;
+    }
+
     PyEval_RestoreThread(static_cast<PyThreadState*>(p));
     p = nullptr;
+
+    if (is_batching) {
+        batched = this;
+        return GIL_scoped{nullptr};
+    }
     return GIL_scoped{this};
 }
 void Interpreter::release()
@@ -121,6 +379,190 @@ void Interpreter::release()
     p = PyEval_SaveThread();
 }
 
+Interpreter::Batch_scoped::Batch_scoped() noexcept
+{
+    is_batching = true;
+}
+Interpreter::Batch_scoped::~Batch_scoped()
+{
+    is_batching = false;
+    if (batched) {
+        batched->release();
+        batched = nullptr;
+    }
+}
+
+Interpreter::ThreadState_scoped::ThreadState_scoped(void *tstate) noexcept:
+    tstate{tstate}
+{}
+Interpreter::ThreadState_scoped::~ThreadState_scoped()
+{
+    PyThreadState_Clear(static_cast<PyThreadState*>(tstate));
+    PyThreadState_DeleteCurrent();
+}
+auto Interpreter::acquire_on_current_thread() -> ThreadState_scoped
+{
+    auto *interp = state ? static_cast<PyInterpreterState*>(state) : PyInterpreterState_Main();
+
+    auto *tstate = PyThreadState_New(interp);
+    if (tstate == nullptr)
+        errx(1, "%s failed", "PyThreadState_New");
+    PyEval_AcquireThread(tstate);
+
+    return ThreadState_scoped{tstate};
+}
+
+bool Interpreter::is_on_main_thread() noexcept
+{
+    return std::this_thread::get_id() == main_thread_id;
+}
+
+/**
+ * Source of the builtin module `swaystatus`, whose awaitables are driven by the poller.
+ */
+static constexpr const char *builtin_module_code = R"(
+class _Awaitable:
+    __slots__ = ("fd", "timeout")
+
+    def __init__(self, fd, timeout):
+        self.fd = fd
+        self.timeout = timeout
+
+    def __await__(self):
+        yield self
+
+def wait_readable(fd):
+    """Wait until fd, an int or an object with fileno(), is readable."""
+    if not isinstance(fd, int):
+        fd = fd.fileno()
+    if fd < 0:
+        raise ValueError("Invalid fd")
+    return _Awaitable(fd, 0)
+
+def sleep(seconds):
+    """Wait for seconds."""
+    if seconds < 0:
+        raise ValueError("Negative seconds")
+    return _Awaitable(-1, int(seconds * 1000))
+)";
+
+/**
+ * Object of type swaystatus.NativeView, which exports a snapshot of NativeView through the
+ * buffer protocol without copying it.
+ */
+struct PyNativeSnapshot {
+    PyObject_HEAD
+    /**
+     * Allocated by new, since python does not construct C++ members.
+     */
+    std::shared_ptr<const NativeSnapshot> *snapshot;
+    Py_ssize_t shape;
+};
+
+static int native_snapshot_getbuffer(PyObject *self, Py_buffer *view, int flags)
+{
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "NativeView is read-only");
+        return -1;
+    }
+
+    auto *obj = reinterpret_cast<PyNativeSnapshot*>(self);
+    const auto &snapshot = **obj->snapshot;
+
+    Py_INCREF(self);
+    view->obj = self;
+    view->buf = const_cast<char*>(snapshot.data.data());
+    view->len = snapshot.data.size();
+    view->readonly = 1;
+    view->itemsize = snapshot.itemsize;
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>(snapshot.format) : nullptr;
+    view->ndim = 1;
+    view->shape = (flags & PyBUF_ND) ? &obj->shape : nullptr;
+    view->strides = (flags & PyBUF_STRIDES) ? &view->itemsize : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = nullptr;
+
+    return 0;
+}
+static void native_snapshot_dealloc(PyObject *self)
+{
+    auto *type = Py_TYPE(self);
+
+    delete reinterpret_cast<PyNativeSnapshot*>(self)->snapshot;
+    type->tp_free(self);
+    // Instances of heap types hold a reference to their type.
+    Py_DECREF(type);
+}
+
+/**
+ * swaystatus.view(name), whose self is the type swaystatus.NativeView
+ */
+static PyObject* get_native_snapshot(PyObject *type, PyObject *name)
+{
+    Py_ssize_t size;
+    auto *s = PyUnicode_AsUTF8AndSize(name, &size);
+    if (s == nullptr)
+        return nullptr;
+
+    auto *view = get_native_view({s, static_cast<std::size_t>(size)});
+    if (view == nullptr) {
+        PyErr_Format(PyExc_KeyError, "No native view named %U", name);
+        return nullptr;
+    }
+
+    auto snapshot = view->get();
+    if (!snapshot)
+        Py_RETURN_NONE;
+
+    auto *tp = reinterpret_cast<PyTypeObject*>(type);
+    auto *obj = reinterpret_cast<PyNativeSnapshot*>(tp->tp_alloc(tp, 0));
+    if (obj == nullptr)
+        return nullptr;
+
+    obj->shape = snapshot->data.size() / snapshot->itemsize;
+    obj->snapshot = new std::shared_ptr<const NativeSnapshot>{std::move(snapshot)};
+
+    return reinterpret_cast<PyObject*>(obj);
+}
+
+static PyMethodDef native_view_method = {
+    "view", get_native_snapshot, METH_O,
+    "view(name) -> NativeView or None\n"
+    "\n"
+    "Get the latest snapshot of data collected by a module, which can be read with\n"
+    "memoryview(). None is returned until the module updates after the first call."
+};
+
+/**
+ * Add view() and NativeView to the builtin module, types are created per interpreter.
+ */
+static void add_native_views(Module &module)
+{
+    static PyType_Slot slots[] = {
+        {Py_tp_dealloc, reinterpret_cast<void*>(native_snapshot_dealloc)},
+        {Py_bf_getbuffer, reinterpret_cast<void*>(native_snapshot_getbuffer)},
+        {0, nullptr},
+    };
+    static PyType_Spec spec = {
+        .name = "swaystatus.NativeView",
+        .basicsize = sizeof(PyNativeSnapshot),
+        .itemsize = 0,
+        .flags = Py_TPFLAGS_DEFAULT,
+        .slots = slots,
+    };
+
+    Object type{PyType_FromSpec(&spec)};
+    if (!type.has_value())
+        Py_Err("%s failed", "PyType_FromSpec");
+
+    Object view{PyCFunction_NewEx(&native_view_method, getPyObject(type), nullptr)};
+    if (!view.has_value())
+        Py_Err("%s failed", "PyCFunction_NewEx");
+
+    module.setattr("NativeView", std::move(type));
+    module.setattr("view", std::move(view));
+}
+
 static void initialize_interpreter()
 {
     Module sys("sys");
@@ -130,11 +572,17 @@ static void initialize_interpreter()
 
     sys.setattr("__stdin__", Object::get_none());
     sys.setattr("__stdout__", Object::get_none());
+
+    // Registered in sys.modules, so that it can be imported.
+    Compiled compiled{"swaystatus", builtin_module_code};
+    Module module{"swaystatus", compiled};
+    add_native_views(module);
 }
 void MainInterpreter::load_libpython3()
 {
-    if (Py_IsInitialized())
+    if (libpython3)
         return;
+    dlopen_libpython3();
 
     PyConfig cfg;
     PyConfig_InitPythonConfig(&cfg);
@@ -152,6 +600,7 @@ void MainInterpreter::load_libpython3()
      * Changed in version 3.7: Py_Initialize() now initializes the GIL.
      */
     Py_InitializeEx(0);
+    main_thread_id = std::this_thread::get_id();
     initialize_interpreter();
     get().release();
 }
@@ -163,23 +612,53 @@ auto MainInterpreter::get() noexcept -> Interpreter&
 }
 bool MainInterpreter::has_initialized() noexcept
 {
-    return Py_IsInitialized();
+    return libpython3 != nullptr && Py_IsInitialized();
 }
 
-SubInterpreter::SubInterpreter():
-    Interpreter{Py_NewInterpreter()}
+/**
+ * @return the thread state of the new interpreter, which is set as the current one.
+ */
+static void* new_interpreter()
 {
-    if (p == nullptr)
+#  if PY_VERSION_HEX >= 0x030C0000
+    PyInterpreterConfig config = {
+        .use_main_obmalloc = 0,
+        .allow_fork = 0,
+        .allow_exec = 0,
+        .allow_threads = 1,
+        .allow_daemon_threads = 0,
+        .check_multi_interp_extensions = 1,
+        .gil = PyInterpreterConfig_OWN_GIL,
+    };
+
+    PyThreadState *tstate = nullptr;
+    PyStatus status = Py_NewInterpreterFromConfig(&tstate, &config);
+    if (PyStatus_Exception(status))
+        errx(1, "%s failed: %s", "Py_NewInterpreterFromConfig",
+                status.err_msg ? status.err_msg : "Unknown error");
+
+    return tstate;
+#  else
+    auto *tstate = Py_NewInterpreter();
+    if (tstate == nullptr)
         Py_Err("%s failed", "Py_NewInterpreter");
 
-    auto *saved = PyEval_SaveThread();
+    return tstate;
+#  endif
+}
 
-    {
-        auto scope = acquire();
-        initialize_interpreter();
-    }
+SubInterpreter::SubInterpreter():
+    Interpreter{nullptr}
+{
+    auto *main_tstate = PyThreadState_Get();
+
+    p = new_interpreter();
+    state = get_interpreter_state(p);
+
+    initialize_interpreter();
+    release();
 
-    PyEval_RestoreThread(saved);
+    PyEval_RestoreThread(main_tstate);
 }
 SubInterpreter::SubInterpreter(SubInterpreter &&other):
     Interpreter{other.p}
@@ -203,13 +682,9 @@ SubInterpreter::~SubInterpreter()
     }
 }
 
-static PyObject* getPyObject(Object &o)
+bool SubInterpreter::has_own_gil() noexcept
 {
-    return static_cast<PyObject*>(o.get());
-}
-static PyObject* getPyObject(const Object &o)
-{
-    return static_cast<PyObject*>(const_cast<void*>(o.get()));
+    return PY_VERSION_HEX >= 0x030C0000;
 }
 
 Object Object::get_none() noexcept
@@ -399,6 +874,19 @@ static auto* PyMemoryView_FromMemory_Checked(const std::string_view &view)
 MemoryView::MemoryView(const std::string_view &view):
     Object{PyMemoryView_FromMemory_Checked(view)}
 {}
+MemoryView::MemoryView(char *data, std::size_t len):
+    Object{PyMemoryView_FromMemory(data, len, PyBUF_WRITE)}
+{
+    if (get() == nullptr)
+        Py_Err("%s failed", "PyMemoryView_FromMemory");
+}
+
+void MemoryView::release()
+{
+    Object ret{PyObject_CallMethod(getPyObject(*this), "release", nullptr)};
+    if (!ret.has_value())
+        Py_Err("%s failed", "memoryview.release");
+}
 
 static auto* PyUnicode_DecodeUTF8_Checked(const std::string_view &view)
 {
@@ -505,14 +993,78 @@ Callable_base::Callable_base(Object &&o):
     Object{check_for_callable(o)}
 {}
 
-auto Callable_base::get_caller() -> caller_t
+bool Coroutine::check(const Object &obj) noexcept
 {
-    return reinterpret_cast<caller_t>(PyObject_CallFunctionObjArgs);
+    return PyCoro_CheckExact(getPyObject(obj));
 }
+Coroutine::Coroutine(Object &&obj) noexcept:
+    Object{std::move(obj)}
+{}
 
-void Callable_base::handle_error()
+bool Coroutine::resume(Request &request)
 {
-    Py_Err("Calling object %p failed", get());
+    auto *ret = PyObject_CallMethod(getPyObject(*this), "send", "O", Py_None);
+    if (ret == nullptr) {
+        if (PyErr_ExceptionMatches(PyExc_StopIteration)) {
+            PyErr_Clear();
+            return false;
+        }
+        Py_Err("Calling object %p failed", get());
+    }
+
+    Object awaited{ret};
+    auto *p = getPyObject(awaited);
+    if (!PyObject_HasAttrString(p, "fd") || !PyObject_HasAttrString(p, "timeout"))
+        errx(1, "Coroutine %p awaits object not from module %s", get(), "swaystatus");
+
+    ssize_t fd;
+    std::size_t timeout;
+    if (!Int{awaited.getattr("fd")}.to_ssize_t(&fd) ||
+        !Int{awaited.getattr("timeout")}.to_size_t(&timeout))
+        Py_Err("%s failed", "Coroutine::resume");
+
+    request.fd = static_cast<int>(fd);
+    request.timeout = timeout;
+
+    return true;
+}
+
+bool Callable_base::is_coroutine_function()
+{
+    Module inspect{"inspect"};
+
+    Object ret{PyObject_CallMethod(
+        getPyObject(inspect), "iscoroutinefunction", "O", getPyObject(*this)
+    )};
+    if (!ret.has_value())
+        Py_Err("%s failed", "inspect.iscoroutinefunction");
+
+    return PyObject_IsTrue(getPyObject(ret)) == 1;
+}
+
+auto Callable_base::call(void **args, std::size_t nargs) -> Object
+{
+    auto **argv = reinterpret_cast<PyObject**>(args);
+
+#  if PY_VERSION_HEX >= 0x030B0000
+    auto *ret = PyObject_Vectorcall(
+        getPyObject(*this), argv, nargs | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr
+    );
+#  else
+    Object packed{PyTuple_New(nargs)};
+    if (!packed.has_value())
+        Py_Err("%s failed", "PyTuple_New");
+    for (std::size_t i = 0; i != nargs; ++i) {
+        Py_INCREF(argv[i]);
+        PyTuple_SET_ITEM(getPyObject(packed), i, argv[i]);
+    }
+    auto *ret = PyObject_Call(getPyObject(*this), getPyObject(packed), nullptr);
+#  endif
+
+    if (ret == nullptr)
+        Py_Err("Calling object %p failed", get());
+
+    return Object{ret};
 }
 } /* namespace swaystatus::python */
 
@@ -18,6 +18,7 @@ void setup_pythonpath(const char *path);
 }
 
 # include <cinttypes>
+# include <cstdint>
 # include <utility>
 # include <type_traits>
 # include <initializer_list>
@@ -27,7 +28,14 @@ void setup_pythonpath(const char *path);
 namespace swaystatus::python {
 class Interpreter {
 protected:
+    /**
+     * Thread state saved by release(), only usable by the thread creating the interpreter.
+     */
     void *p;
+    /**
+     * PyInterpreterState of the interpreter, nullptr for the main interpreter.
+     */
+    void *state = nullptr;
 
     Interpreter(void *p) noexcept;
 
@@ -48,9 +56,59 @@ public:
      *
      * acquire can be called on the same object multiple times
      * and only the first call will actually acquire the GIL lock.
+     *
+     * @pre is_on_main_thread()
      */
     auto acquire() -> GIL_scoped;
     void release();
+
+    /**
+     * Batch_scoped keeps the interpreter acquired by acquire() in its scope until it is
+     * destroyed, so that all python calls in its scope only acquire the GIL once.
+     *
+     * Acquiring another interpreter releases the one kept before.
+     * Batch_scoped cannot be nested.
+     */
+    class Batch_scoped {
+    public:
+        /**
+         * @pre is_on_main_thread()
+         */
+        Batch_scoped() noexcept;
+
+        Batch_scoped(const Batch_scoped&) = delete;
+        Batch_scoped& operator = (const Batch_scoped&) = delete;
+
+        ~Batch_scoped();
+    };
+
+    /**
+     * ThreadState_scoped holds the GIL with a thread state created for the calling thread,
+     * which is destroyed along with the GIL released in dtor.
+     */
+    class ThreadState_scoped {
+        void *tstate;
+
+    public:
+        ThreadState_scoped(void *tstate) noexcept;
+
+        ThreadState_scoped(const ThreadState_scoped&) = delete;
+        ThreadState_scoped& operator = (const ThreadState_scoped&) = delete;
+
+        ~ThreadState_scoped();
+    };
+    /**
+     * Acquire the GIL on threads other than the one calling load_libpython3(),
+     * since the thread state saved by acquire() can only be used by that thread.
+     *
+     * Unlike acquire(), it must not be nested.
+     */
+    auto acquire_on_current_thread() -> ThreadState_scoped;
+
+    /**
+     * @return true if called by the thread calling load_libpython3().
+     */
+    static bool is_on_main_thread() noexcept;
 };
 
 class MainInterpreter: public Interpreter {
@@ -60,17 +118,30 @@ public:
     /**
      * @pre setup_pythonpath has been invoked
      *
-     * load_libpython3() will only initialize libpython on the first call.
+     * load_libpython3() will only load libpython by dlopen and initialize it on the first
+     * call, so that nothing is paid for python until a python callable is created.
      */
     static void load_libpython3();
 
+    /**
+     * @return false if libpython is not loaded yet.
+     */
     static bool has_initialized() noexcept;
 
     static auto get() noexcept -> Interpreter&;
 };
 
+/**
+ * Since python 3.12, each SubInterpreter has its own GIL, so code running in different
+ * SubInterpreter can run in parallel.
+ *
+ * Extension modules that do not support multiple interpreters cannot be imported.
+ */
 class SubInterpreter: public Interpreter {
 public:
+    /**
+     * @pre the GIL of the main interpreter is held, it is still held after the ctor returns.
+     */
     SubInterpreter();
 
     SubInterpreter(const SubInterpreter&) = delete;
@@ -80,9 +151,15 @@ public:
     SubInterpreter& operator = (SubInterpreter&&) = delete;
 
     /**
-     * ~SubInterpreter() can only be called when the SubInterpreter is not loaded (after release()).
+     * ~SubInterpreter() can only be called when the SubInterpreter is not loaded (after release())
+     * and the GIL of the main interpreter is held.
      */
     ~SubInterpreter();
+
+    /**
+     * @return true if SubInterpreter has its own GIL.
+     */
+    static bool has_own_gil() noexcept;
 };
 
 class Object {
@@ -250,7 +327,22 @@ struct Conversion<T, std::enable_if_t< std::is_constructible_v< Int, T > && !is_
 
 class MemoryView: public Object {
 public:
+    /**
+     * Create a read-only memoryview.
+     */
     MemoryView(const std::string_view &view);
+    /**
+     * Create a writable memoryview.
+     */
+    MemoryView(char *data, std::size_t len);
+
+    /**
+     * Release the memory, so that it can no longer be accessed from python even if the
+     * memoryview is kept.
+     *
+     * Call errx if it has been exported.
+     */
+    void release();
 };
 
 template <class T>
@@ -402,11 +494,11 @@ public:
 
 class Callable_base: public Object {
 protected:
-    using caller_t = void* (*)(void*, ...);
-
-    static auto get_caller() -> caller_t;
-
-    void handle_error();
+    /**
+     * @param args args[-1] must be writable, so that the callee can use it to prepend
+     *             self without allocating.
+     */
+    auto call(void **args, std::size_t nargs) -> Object;
 
 public:
     /**
@@ -416,6 +508,11 @@ public:
      */
     explicit Callable_base(Object &&o);
 
+    /**
+     * @return true if it is defined with `async def`, which returns a coroutine.
+     */
+    bool is_coroutine_function();
+
     /**
      * @exception If the object throws, then the error is printed to stderr and _exit is called.
      */
@@ -427,20 +524,15 @@ public:
     >
     Object operator () (Args &&...args)
     {
-        auto *ret = (get_caller())(get(), std::forward<Args>(args).get()..., NULL);
-        if (ret == nullptr)
-            handle_error();
-
-        return Object{ret};
+        // Passed by vectorcall, so no tuple is created for them.
+        void *argv[] = {nullptr, args.get()...};
+        return call(argv + 1, sizeof...(args));
     }
 
     Object operator () ()
     {
-        auto *ret = (get_caller())(get(), NULL);
-        if (ret == nullptr)
-            handle_error();
-
-        return Object{ret};
+        void *argv[] = {nullptr};
+        return call(argv + 1, 0);
     }
 };
 
@@ -475,6 +567,43 @@ public:
         };
     }
 };
+
+/**
+ * Coroutine returned by calling an `async def` function.
+ *
+ * It can only await awaitables of the builtin module `swaystatus`, which yield what they wait
+ * for to the caller of resume() instead of an asyncio event loop.
+ */
+class Coroutine: public Object {
+public:
+    struct Request {
+        /**
+         * -1 if it waits for timeout
+         */
+        int fd;
+        /**
+         * In ms
+         */
+        std::uint64_t timeout;
+    };
+
+    /**
+     * @return true if obj is a coroutine.
+     */
+    static bool check(const Object &obj) noexcept;
+
+    /**
+     * @param obj must be a coroutine
+     */
+    explicit Coroutine(Object &&obj) noexcept;
+
+    /**
+     * Run the coroutine until it awaits or returns.
+     *
+     * @return false if it returns, otherwise request is set to what it awaits.
+     */
+    bool resume(Request &request);
+};
 } /* namespace swaystatus */
 #  endif
 
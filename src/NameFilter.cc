@@ -0,0 +1,88 @@
+#include <cstring>
+
+#include <fnmatch.h>
+
+#include "process_configuration.h"
+#include "NameFilter.hpp"
+
+namespace swaystatus {
+NameFilter::Pattern::Pattern(const char *pattern):
+    str{pattern}
+{
+    auto pos = str.find_first_of("*?[\\");
+    if (pos == std::string::npos)
+        type = Type::exact;
+    else if (pos == str.size() - 1 && str.back() == '*') {
+        type = Type::prefix;
+        str.pop_back();
+    } else
+        type = Type::glob;
+
+    str.shrink_to_fit();
+}
+bool NameFilter::Pattern::matches(const char *name) const noexcept
+{
+    switch (type) {
+        case Type::exact:
+            return std::strcmp(name, str.c_str()) == 0;
+
+        case Type::prefix:
+            return std::strncmp(name, str.c_str(), str.size()) == 0;
+
+        case Type::glob:
+        default:
+            return fnmatch(str.c_str(), name, 0) == 0;
+    }
+}
+
+NameFilter::NameFilter(const char * const *includes_arg, const char * const *excludes_arg)
+{
+    if (includes_arg) {
+        for (auto it = includes_arg; *it; ++it)
+            includes.emplace_back(*it);
+    }
+    if (excludes_arg) {
+        for (auto it = excludes_arg; *it; ++it)
+            excludes.emplace_back(*it);
+    }
+
+    includes.shrink_to_fit();
+    excludes.shrink_to_fit();
+}
+
+auto NameFilter::from_config(const void *module_config, const char *module_name,
+                             const char *include_property, const char *exclude_property)
+    -> NameFilter
+{
+    auto *includes = get_property_array(module_config, module_name, include_property);
+    auto *excludes = get_property_array(module_config, module_name, exclude_property);
+
+    NameFilter filter{includes, excludes};
+
+    free_property_array(includes);
+    free_property_array(excludes);
+
+    return filter;
+}
+
+bool NameFilter::matches_any(const std::vector<Pattern> &patterns, const char *name) noexcept
+{
+    for (const auto &pattern: patterns) {
+        if (pattern.matches(name))
+            return true;
+    }
+    return false;
+}
+
+bool NameFilter::is_empty() const noexcept
+{
+    return includes.empty() && excludes.empty();
+}
+
+bool NameFilter::matches(const char *name) const noexcept
+{
+    if (!includes.empty() && !matches_any(includes, name))
+        return false;
+    return !matches_any(excludes, name);
+}
+} /* namespace swaystatus */
@@ -0,0 +1,75 @@
+#ifndef  __swaystatus_NameFilter_HPP__
+# define __swaystatus_NameFilter_HPP__
+
+# include <cstdint>
+# include <string>
+# include <vector>
+
+namespace swaystatus {
+/**
+ * NameFilter matches names against include and exclude glob patterns, which are compiled
+ * once in ctor.
+ *
+ * A name passes the filter if include patterns are empty or it matches any of them,
+ * and it matches none of the exclude patterns.
+ *
+ * Pattern without any wildcard is compared directly, pattern whose only wildcard is the
+ * trailing '*' is compared as prefix and the rest are matched using fnmatch.
+ */
+class NameFilter {
+    struct Pattern {
+        enum class Type: std::uint8_t {
+            exact,
+            prefix,
+            glob,
+        };
+
+        Type type;
+        std::string str;
+
+        Pattern(const char *pattern);
+
+        bool matches(const char *name) const noexcept;
+    };
+
+    std::vector<Pattern> includes;
+    std::vector<Pattern> excludes;
+
+    static bool matches_any(const std::vector<Pattern> &patterns, const char *name) noexcept;
+
+public:
+    NameFilter() = default;
+
+    /**
+     * @param includes NULL-terminated array, can be NULL
+     * @param excludes NULL-terminated array, can be NULL
+     */
+    NameFilter(const char * const *includes, const char * const *excludes);
+
+    /**
+     * @param module_name used only for printing err msg
+     * @param include_property name of the property containing include patterns
+     * @param exclude_property name of the property containing exclude patterns
+     */
+    static auto from_config(const void *module_config, const char *module_name,
+                            const char *include_property, const char *exclude_property)
+        -> NameFilter;
+
+    NameFilter(NameFilter&&) = default;
+    NameFilter& operator = (NameFilter&&) = default;
+
+    ~NameFilter() = default;
+
+    /**
+     * @return true if no pattern is specified.
+     */
+    bool is_empty() const noexcept;
+
+    /**
+     * @param name must be null-terminated
+     */
+    bool matches(const char *name) const noexcept;
+};
+} /* namespace swaystatus */
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef  __swaystatus_RingBuffer_HPP__
+# define __swaystatus_RingBuffer_HPP__
+
+# include <cstddef>
+# include <memory>
+# include <utility>
+
+namespace swaystatus {
+/**
+ * RingBuffer keeps the last capacity() samples pushed into it.
+ *
+ * The storage is allocated once in ctor and never grows, once the buffer is full,
+ * push() overwrites the oldest sample.
+ */
+template <class T>
+class RingBuffer {
+    std::unique_ptr<T[]> samples;
+    std::size_t cap = 0;
+    std::size_t cnt = 0;
+    /**
+     * index of the slot the next sample will be written to
+     */
+    std::size_t next = 0;
+
+public:
+    RingBuffer() = default;
+
+    /**
+     * @param capacity must not be 0
+     */
+    explicit RingBuffer(std::size_t capacity):
+        samples{new T[capacity]},
+        cap{capacity}
+    {}
+
+    RingBuffer(const RingBuffer&) = delete;
+    /**
+     * other is left empty with capacity() == 0.
+     */
+    RingBuffer(RingBuffer &&other) noexcept:
+        samples{std::move(other.samples)},
+        cap{std::exchange(other.cap, 0)},
+        cnt{std::exchange(other.cnt, 0)},
+        next{std::exchange(other.next, 0)}
+    {}
+
+    RingBuffer& operator = (const RingBuffer&) = delete;
+    /**
+     * other is left empty with capacity() == 0.
+     */
+    RingBuffer& operator = (RingBuffer &&other) noexcept
+    {
+        samples = std::move(other.samples);
+        cap = std::exchange(other.cap, 0);
+        cnt = std::exchange(other.cnt, 0);
+        next = std::exchange(other.next, 0);
+        return *this;
+    }
+
+    ~RingBuffer() = default;
+
+    /**
+     * No-op if capacity() == 0.
+     */
+    void push(T val) noexcept
+    {
+        if (cap == 0)
+            return;
+
+        samples[next] = val;
+        next = (next + 1) % cap;
+        if (cnt != cap)
+            ++cnt;
+    }
+    void clear() noexcept
+    {
+        cnt = 0;
+        next = 0;
+    }
+
+    auto size() const noexcept -> std::size_t
+    {
+        return cnt;
+    }
+    auto capacity() const noexcept -> std::size_t
+    {
+        return cap;
+    }
+    bool is_empty() const noexcept
+    {
+        return cnt == 0;
+    }
+
+    /**
+     * @param i 0 is the oldest sample, size() - 1 is the latest one.
+     */
+    T operator [] (std::size_t i) const noexcept
+    {
+        return samples[(next + cap - cnt + i) % cap];
+    }
+
+    /**
+     * @return the latest sample or T{} if empty
+     */
+    T back() const noexcept
+    {
+        if (cnt == 0)
+            return T{};
+        return samples[(next + cap - 1) % cap];
+    }
+
+    /**
+     * min(), max() and avg() return T{} if empty
+     */
+    T min() const noexcept
+    {
+        if (cnt == 0)
+            return T{};
+
+        T ret = samples[0];
+        for (std::size_t i = 1; i != cnt; ++i) {
+            if (samples[i] < ret)
+                ret = samples[i];
+        }
+        return ret;
+    }
+    T max() const noexcept
+    {
+        if (cnt == 0)
+            return T{};
+
+        T ret = samples[0];
+        for (std::size_t i = 1; i != cnt; ++i) {
+            if (ret < samples[i])
+                ret = samples[i];
+        }
+        return ret;
+    }
+    T avg() const noexcept
+    {
+        if (cnt == 0)
+            return T{};
+
+        T sum{};
+        for (std::size_t i = 0; i != cnt; ++i)
+            sum += samples[i];
+        return sum / cnt;
+    }
+};
+} /* namespace swaystatus */
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef  __swaystatus_TripleBuffer_HPP__
+# define __swaystatus_TripleBuffer_HPP__
+
+# include <cstdint>
+# include <atomic>
+
+namespace swaystatus {
+/**
+ * TripleBuffer hands off values from a single writer thread to a single reader thread
+ * without locking.
+ *
+ * The writer fills the back buffer and publishes it by swapping it with the middle one,
+ * while the reader takes the middle one by swapping it with its front buffer.
+ * Since each side only ever touches the buffer it owns, the reader always sees the latest
+ * complete value even if the writer publishes again in the meantime, which is not the
+ * case with only two buffers.
+ */
+template <class T>
+class TripleBuffer {
+    static constexpr const std::uint8_t index_mask = 0x3;
+    /**
+     * Set in middle when it holds a value the reader has not taken yet.
+     */
+    static constexpr const std::uint8_t fresh = 0x4;
+
+    T buffers[3];
+
+    std::atomic<std::uint8_t> middle{1};
+    /**
+     * Only accessed by the writer
+     */
+    std::uint8_t back = 2;
+    /**
+     * Only accessed by the reader
+     */
+    std::uint8_t front = 0;
+
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator = (const TripleBuffer&) = delete;
+
+    ~TripleBuffer() = default;
+
+    /**
+     * Called by the writer.
+     *
+     * @return buffer to be filled before publish(), it might contain a value published before.
+     */
+    auto get_back() noexcept -> T&
+    {
+        return buffers[back];
+    }
+    /**
+     * Called by the writer.
+     */
+    void publish() noexcept
+    {
+        back = middle.exchange(back | fresh, std::memory_order_acq_rel) & index_mask;
+    }
+
+    /**
+     * Called by the reader.
+     *
+     * @return true if a new value is published since the last call.
+     */
+    bool update_front() noexcept
+    {
+        if (!(middle.load(std::memory_order_relaxed) & fresh))
+            return false;
+
+        front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+        return true;
+    }
+    /**
+     * Called by the reader.
+     *
+     * @return value taken by the last update_front(), or a default-constructed one.
+     */
+    auto get_front() const noexcept -> const T&
+    {
+        return buffers[front];
+    }
+};
+} /* namespace swaystatus */
+
+#endif
@@ -16,16 +16,87 @@
 
 #include <err.h>
 #include <alloca.h>
+#include <dlfcn.h>
 
 #include "alsa.h"
 
+/**
+ * libasound is not linked, but loaded by dlopen in load_alsa_lib(), so that swaystatus
+ * pays nothing for it unless volume is enabled.
+ *
+ * Every function of libasound used here is resolved into a pointer asound_<name> and its
+ * name is redirected to the pointer with a macro.
+ */
+#define ASOUND_FUNCTIONS(X)                     \
+    X(snd_config_update_free_global)            \
+    X(snd_mixer_attach)                         \
+    X(snd_mixer_close)                          \
+    X(snd_mixer_find_selem)                     \
+    X(snd_mixer_handle_events)                  \
+    X(snd_mixer_load)                           \
+    X(snd_mixer_open)                           \
+    X(snd_mixer_selem_get_playback_volume)      \
+    X(snd_mixer_selem_get_playback_volume_range)\
+    X(snd_mixer_selem_id_set_index)             \
+    X(snd_mixer_selem_id_set_name)              \
+    X(snd_mixer_selem_id_sizeof)                \
+    X(snd_mixer_selem_register)                 \
+    X(snd_mixer_wait)
+
+#define DEFINE_ASOUND_FUNCTION(name) static __typeof__(&name) asound_##name;
+ASOUND_FUNCTIONS(DEFINE_ASOUND_FUNCTION)
+#undef DEFINE_ASOUND_FUNCTION
+
+#define snd_config_update_free_global (*asound_snd_config_update_free_global)
+#define snd_mixer_attach (*asound_snd_mixer_attach)
+#define snd_mixer_close (*asound_snd_mixer_close)
+#define snd_mixer_find_selem (*asound_snd_mixer_find_selem)
+#define snd_mixer_handle_events (*asound_snd_mixer_handle_events)
+#define snd_mixer_load (*asound_snd_mixer_load)
+#define snd_mixer_open (*asound_snd_mixer_open)
+#define snd_mixer_selem_get_playback_volume (*asound_snd_mixer_selem_get_playback_volume)
+#define snd_mixer_selem_get_playback_volume_range \
+    (*asound_snd_mixer_selem_get_playback_volume_range)
+#define snd_mixer_selem_id_set_index (*asound_snd_mixer_selem_id_set_index)
+#define snd_mixer_selem_id_set_name (*asound_snd_mixer_selem_id_set_name)
+#define snd_mixer_selem_id_sizeof (*asound_snd_mixer_selem_id_sizeof)
+#define snd_mixer_selem_register (*asound_snd_mixer_selem_register)
+#define snd_mixer_wait (*asound_snd_mixer_wait)
+
+static void *libasound;
+
+bool load_alsa_lib()
+{
+    if (libasound)
+        return true;
+
+    void *lib = dlopen("libasound.so.2", RTLD_NOW | RTLD_LOCAL);
+    if (lib == NULL) {
+        warnx("%s on %s failed: %s", "dlopen", "libasound.so.2", dlerror());
+        return false;
+    }
+
+#define LOAD_ASOUND_FUNCTION(name)                                          \
+    asound_##name = (__typeof__(asound_##name)) dlsym(lib, #name);          \
+    if (asound_##name == NULL) {                                            \
+        warnx("%s on %s failed: %s", "dlsym", #name, dlerror());            \
+        dlclose(lib);                                                       \
+        return false;                                                       \
+    }
+    ASOUND_FUNCTIONS(LOAD_ASOUND_FUNCTION)
+#undef LOAD_ASOUND_FUNCTION
+
+    libasound = lib;
+    return true;
+}
+
 static snd_mixer_t *handle;
 static snd_mixer_elem_t *elem;
 static long volume;
 
 static long calculate_audio_volume();
 
-void initialize_alsa_lib(const char *mix_name, const char *card)
+bool initialize_alsa_lib(const char *mix_name, const char *card)
 {
     snd_mixer_selem_id_t *sid;
     snd_mixer_selem_id_alloca(&sid);
@@ -33,26 +104,37 @@ void initialize_alsa_lib(const char *mix_name, const char *card)
     snd_mixer_selem_id_set_index(sid, 0);
     snd_mixer_selem_id_set_name(sid, mix_name);
 
-    if (snd_mixer_open(&handle, 0) < 0)
-        errx(1, "%s failed", "snd_mixer_open");
+    if (snd_mixer_open(&handle, 0) < 0) {
+        warnx("%s failed", "snd_mixer_open");
+        return false;
+    }
 
+    const char *failed = NULL;
+    const char *failed_on = card;
     if (snd_mixer_attach(handle, card) < 0)
-        errx(1, "%s failed", "snd_mixer_attach");
-
-    if (snd_mixer_selem_register(handle, NULL, NULL) < 0)
-        errx(1, "%s failed", "snd_mixer_selem_register");
-
-    if (snd_mixer_load(handle) < 0)
-        errx(1, "%s failed", "snd_mixer_load");
+        failed = "snd_mixer_attach";
+    else if (snd_mixer_selem_register(handle, NULL, NULL) < 0)
+        failed = "snd_mixer_selem_register";
+    else if (snd_mixer_load(handle) < 0)
+        failed = "snd_mixer_load";
+    else if ((elem = snd_mixer_find_selem(handle, sid)) == NULL) {
+        failed = "snd_mixer_find_selem";
+        failed_on = mix_name;
+    }
 
-    elem = snd_mixer_find_selem(handle, sid);
-    if (!elem)
-        errx(1, "%s failed", "snd_mixer_find_selem");
+    if (failed) {
+        warnx("%s on %s failed", failed, failed_on);
+        snd_mixer_close(handle);
+        handle = NULL;
+        return false;
+    }
 
     if (snd_config_update_free_global() < 0)
         errx(1, "%s failed", "snd_config_update_free_global");
 
     volume = calculate_audio_volume();
+
+    return true;
 }
 
 static long calculate_audio_volume()
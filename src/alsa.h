@@ -4,11 +4,24 @@
 #ifndef  __swaystatus_alsa_H__
 # define __swaystatus_alsa_H__
 
+# include <stdbool.h>
+
 # ifdef __cplusplus
 extern "C" {
 # endif
 
-void initialize_alsa_lib(const char *mix_name, const char *card);
+/**
+ * Load libasound on the first call.
+ *
+ * @return false if libasound is not available, with the reason printed to stderr.
+ */
+bool load_alsa_lib();
+
+/**
+ * @pre load_alsa_lib() succeeds
+ * @return false if card or mix_name cannot be opened, with the reason printed to stderr.
+ */
+bool initialize_alsa_lib(const char *mix_name, const char *card);
 
 void update_volume();
 long get_audio_volume();
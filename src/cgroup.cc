@@ -0,0 +1,461 @@
+#ifndef  _GNU_SOURCE
+# define _GNU_SOURCE     /* For strchrnul */
+#endif
+
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>         /* For O_RDONLY */
+#include <unistd.h>        /* For pread */
+#include <sys/inotify.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
+
+#include "utility.h"
+#include "mem_size_t.hpp"
+#include "formatting/fmt_utility.hpp"
+#include "formatting/Conditional.hpp"
+#include "cgroup.hpp"
+
+namespace swaystatus {
+static constexpr const char *cgroup_root = "/sys/fs/cgroup/";
+
+static constexpr const char * const pressure_filenames[] = {
+    "cpu.pressure",
+    "memory.pressure",
+    "io.pressure",
+};
+
+/**
+ * @return false if the cgroup is removed, which makes all its files return ENODEV.
+ */
+static bool pread_cgroup_file(int fd, const std::string &path, const char *filename,
+                              char *buffer, std::size_t len)
+{
+    ssize_t cnt;
+    do {
+        cnt = pread(fd, buffer, len - 1, 0);
+    } while (cnt < 0 && errno == EINTR);
+
+    if (cnt < 0) {
+        if (errno == ENODEV || errno == ENOENT)
+            return false;
+        err(1, "%s on %s%s failed", "pread", path.c_str(), filename);
+    }
+    buffer[cnt] = '\0';
+
+    return true;
+}
+
+struct keyed_field {
+    std::string_view key;
+    std::uint64_t *val;
+};
+/**
+ * Parse flat keyed file like memory.events and cpu.stat, where each line is "<key> <value>".
+ *
+ * Keys not in fields are ignored.
+ */
+static void parse_flat_keyed(const char *buffer, std::initializer_list<keyed_field> fields) noexcept
+{
+    const char *line = buffer;
+    while (*line != '\0') {
+        const char *space = std::strchr(line, ' ');
+        if (!space)
+            break;
+
+        std::string_view key{line, static_cast<std::size_t>(space - line)};
+        char *endptr;
+        std::uint64_t val = std::strtoull(space + 1, &endptr, 10);
+
+        for (const auto &field: fields) {
+            if (field.key == key) {
+                *field.val = val;
+                break;
+            }
+        }
+
+        line = strchrnul(endptr, '\n');
+        if (*line == '\n')
+            ++line;
+    }
+}
+
+static auto get_percentage(std::uint64_t delta_usec, std::uint64_t elapsed_us) noexcept
+    -> std::uint32_t
+{
+    return static_cast<std::uint32_t>((delta_usec * 100 + elapsed_us / 2) / elapsed_us);
+}
+
+Cgroup::Cgroup(std::string_view path_arg)
+{
+    if (path_arg.size() == 0 || path_arg[0] != '/')
+        path = cgroup_root;
+    path.append(path_arg);
+
+    while (path.size() > 1 && path.back() == '/')
+        path.pop_back();
+    path.push_back('/');
+}
+
+auto Cgroup::open_file(const char *filename) -> int
+{
+    int fd;
+    do {
+        fd = openat(AT_FDCWD, (path + filename).c_str(), O_RDONLY | O_CLOEXEC);
+    } while (fd == -1 && errno == EINTR);
+
+    if (fd == -1 && errno != ENOENT)
+        err(1, "openat %s%s with %d failed", path.c_str(), filename, O_RDONLY);
+
+    return fd;
+}
+void Cgroup::close() noexcept
+{
+    available = false;
+    wd = -1;
+
+    memory_current_fd.destroy();
+    memory_max_fd.destroy();
+    memory_events_fd.destroy();
+    cpu_stat_fd.destroy();
+    for (auto &fd: pressure_fds)
+        fd.destroy();
+
+    memory_current = 0;
+    memory_max = 0;
+    memory_percent = 0;
+    has_new_oom = false;
+    cpu_usage = cpu_user_usage = cpu_system_usage = 0;
+}
+
+void Cgroup::open(int inotify_fd)
+{
+    close();
+
+    // cpu.stat exists in every cgroup v2, including the root.
+    int fd = open_file("cpu.stat");
+    if (fd == -1)
+        return;
+    cpu_stat_fd = fd;
+
+    auto open_optional = [this](Fd &fd, const char *filename) {
+        int ret = open_file(filename);
+        if (ret != -1)
+            fd = ret;
+    };
+    open_optional(memory_current_fd, "memory.current");
+    open_optional(memory_max_fd, "memory.max");
+    open_optional(memory_events_fd, "memory.events");
+    for (std::size_t i = 0; i != pressure_cnt; ++i)
+        open_optional(pressure_fds[i], pressure_filenames[i]);
+
+    if (inotify_fd != -1 && memory_events_fd) {
+        // Kernel generates IN_MODIFY on memory.events whenever any of its fields changes.
+        wd = inotify_add_watch(inotify_fd, (path + "memory.events").c_str(), IN_MODIFY);
+        if (wd < 0)
+            err(1, "%s on %s%s failed", "inotify_add_watch", path.c_str(), "memory.events");
+    }
+
+    available = true;
+
+    // Initialize counters so that the first update does not report all ooms ever happened
+    // as new ones.
+    update(0);
+    has_new_oom = false;
+}
+
+bool Cgroup::read_memory()
+{
+    char buffer[256];
+
+    if (memory_current_fd) {
+        if (!pread_cgroup_file(memory_current_fd.get(), path, "memory.current", buffer, sizeof(buffer)))
+            return false;
+        memory_current = std::strtoull(buffer, nullptr, 10);
+    }
+
+    if (memory_max_fd) {
+        if (!pread_cgroup_file(memory_max_fd.get(), path, "memory.max", buffer, sizeof(buffer)))
+            return false;
+        // "max" means there is no limit, which parses as 0
+        memory_max = std::strtoull(buffer, nullptr, 10);
+    }
+
+    if (memory_max != 0)
+        memory_percent = static_cast<std::uint8_t>(
+            memory_current >= memory_max ? 100 : memory_current * 100 / memory_max
+        );
+    else
+        memory_percent = 0;
+
+    if (memory_events_fd) {
+        if (!pread_cgroup_file(memory_events_fd.get(), path, "memory.events", buffer, sizeof(buffer)))
+            return false;
+
+        std::uint64_t oom = oom_count, oom_kill = oom_kill_count;
+        parse_flat_keyed(buffer, {{"oom", &oom}, {"oom_kill", &oom_kill}});
+
+        has_new_oom = oom > oom_count || oom_kill > oom_kill_count;
+        oom_count = oom;
+        oom_kill_count = oom_kill;
+    }
+
+    return true;
+}
+bool Cgroup::read_cpu(std::uint64_t elapsed_us)
+{
+    char buffer[1024];
+
+    if (!pread_cgroup_file(cpu_stat_fd.get(), path, "cpu.stat", buffer, sizeof(buffer)))
+        return false;
+
+    std::uint64_t usage = usage_usec, user = user_usec, system = system_usec;
+    parse_flat_keyed(buffer, {{"usage_usec", &usage}, {"user_usec", &user}, {"system_usec", &system}});
+
+    if (elapsed_us != 0 && usage >= usage_usec && user >= user_usec && system >= system_usec) {
+        cpu_usage = get_percentage(usage - usage_usec, elapsed_us);
+        cpu_user_usage = get_percentage(user - user_usec, elapsed_us);
+        cpu_system_usage = get_percentage(system - system_usec, elapsed_us);
+    } else {
+        cpu_usage = cpu_user_usage = cpu_system_usage = 0;
+    }
+
+    usage_usec = usage;
+    user_usec = user;
+    system_usec = system;
+
+    return true;
+}
+
+void Cgroup::update(std::uint64_t elapsed_us)
+{
+    if (!available)
+        return;
+
+    bool alive = read_memory() && read_cpu(elapsed_us);
+
+    for (std::size_t i = 0; alive && i != pressure_cnt; ++i) {
+        if (!pressure_fds[i])
+            continue;
+
+        char buffer[256];
+        alive = pread_cgroup_file(pressure_fds[i].get(), path, pressure_filenames[i],
+                                  buffer, sizeof(buffer));
+        if (alive)
+            parse_psi(buffer, pressures[i]);
+    }
+
+    if (!alive)
+        close();
+}
+
+bool Cgroup::handle_watch_removed(int removed_wd) noexcept
+{
+    if (wd == -1 || wd != removed_wd)
+        return false;
+
+    close();
+    return true;
+}
+
+bool Cgroup::is_available() const noexcept
+{
+    return available;
+}
+auto Cgroup::get_path() const noexcept -> std::string_view
+{
+    std::string_view ret{path};
+    ret.remove_suffix(1);
+    return ret;
+}
+auto Cgroup::get_name() const noexcept -> std::string_view
+{
+    auto ret = get_path();
+    return ret.substr(ret.rfind('/') + 1);
+}
+
+Cgroups::Cgroups(const char * const *paths, bool watch_events)
+{
+    if (watch_events) {
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0)
+            err(1, "%s failed", "inotify_init1");
+        inotify_fd = fd;
+    }
+
+    for (auto it = paths; *it; ++it)
+        cgroups.emplace_back(*it);
+
+    reload();
+}
+
+int Cgroups::get_inotify_fd() const noexcept
+{
+    return inotify_fd ? inotify_fd.get() : -1;
+}
+bool Cgroups::handle_notifications()
+{
+    alignas(struct inotify_event) char buffer[4096];
+    bool modified = false;
+
+    for (;;) {
+        ssize_t cnt = read(inotify_fd.get(), buffer, sizeof(buffer));
+        if (cnt < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            err(1, "%s on %s failed", "read", "inotify fd");
+        }
+
+        for (char *p = buffer; p < buffer + cnt; ) {
+            const auto *event = reinterpret_cast<const struct inotify_event*>(p);
+            if (event->mask & IN_IGNORED) {
+                for (auto &cgroup: cgroups) {
+                    if (cgroup.handle_watch_removed(event->wd))
+                        break;
+                }
+            }
+            if (event->mask & (IN_MODIFY | IN_IGNORED))
+                modified = true;
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    return modified;
+}
+
+void Cgroups::update()
+{
+    const auto now = get_monotonic_timestamp();
+    const auto elapsed_us = timestamp == 0 ? 0 : (now - timestamp) / 1000;
+    timestamp = now;
+
+    max_memory_percent = 0;
+    oom_kill_count = 0;
+    has_new_oom = false;
+
+    for (auto &cgroup: cgroups) {
+        // open() already reads the cgroup once.
+        if (cgroup.is_available())
+            cgroup.update(elapsed_us);
+        else
+            cgroup.open(get_inotify_fd());
+
+        if (cgroup.memory_percent > max_memory_percent)
+            max_memory_percent = cgroup.memory_percent;
+        oom_kill_count += cgroup.oom_kill_count;
+        has_new_oom |= cgroup.has_new_oom;
+    }
+}
+void Cgroups::reload()
+{
+    for (auto &cgroup: cgroups)
+        cgroup.open(get_inotify_fd());
+
+    timestamp = get_monotonic_timestamp();
+}
+
+auto Cgroups::get_max_memory_percent() const noexcept -> std::uint8_t
+{
+    return max_memory_percent;
+}
+auto Cgroups::get_oom_kill_count() const noexcept -> std::uint64_t
+{
+    return oom_kill_count;
+}
+bool Cgroups::get_has_new_oom() const noexcept
+{
+    return has_new_oom;
+}
+
+auto Cgroups::size() const noexcept -> std::size_t
+{
+    return cgroups.size();
+}
+auto Cgroups::begin() const noexcept -> const_iterator
+{
+    return cgroups.begin();
+}
+auto Cgroups::end() const noexcept -> const_iterator
+{
+    return cgroups.end();
+}
+} /* namespace swaystatus */
+
+using Cgroups_formatter = fmt::formatter<swaystatus::Cgroups>;
+
+auto Cgroups_formatter::parse(format_parse_context &ctx) -> format_parse_context_it
+{
+    auto it = ctx.begin(), end = ctx.end();
+    if (it == end)
+        return it;
+
+    end = swaystatus::find_end_of_format(ctx);
+
+    fmt_str = std::string_view{it, static_cast<std::size_t>(end - it)};
+
+    return end;
+}
+auto Cgroups_formatter::format(const Cgroups &cgroups, format_context &ctx) -> format_context_it
+{
+    using swaystatus::Cgroup;
+    using swaystatus::Conditional;
+    using swaystatus::mem_size_t;
+
+    auto out = ctx.out();
+
+    if (fmt_str.size() == 0)
+        return out;
+
+    std::size_t i = 0;
+    for (const auto &cgroup: cgroups) {
+        const auto &cpu = cgroup.pressures[Cgroup::pressure_cpu];
+        const auto &memory = cgroup.pressures[Cgroup::pressure_memory];
+        const auto &io = cgroup.pressures[Cgroup::pressure_io];
+
+        out = format_to(
+            out,
+            fmt_str,
+            fmt::arg("path",         cgroup.get_path()),
+            fmt::arg("name",         cgroup.get_name()),
+            fmt::arg("is_available", Conditional{cgroup.is_available()}),
+
+            fmt::arg("memory_current", mem_size_t{cgroup.memory_current}),
+            fmt::arg("memory_max",     mem_size_t{cgroup.memory_max}),
+            fmt::arg("has_memory_max", Conditional{cgroup.memory_max != 0}),
+            fmt::arg("memory_percent", cgroup.memory_percent),
+
+            fmt::arg("oom_count",      cgroup.oom_count),
+            fmt::arg("oom_kill_count", cgroup.oom_kill_count),
+            fmt::arg("has_new_oom",    Conditional{cgroup.has_new_oom}),
+
+            fmt::arg("cpu_usage",        cgroup.cpu_usage),
+            fmt::arg("cpu_user_usage",   cgroup.cpu_user_usage),
+            fmt::arg("cpu_system_usage", cgroup.cpu_system_usage),
+
+#define FMT_PSI_LINE(res, line)                                 \
+            fmt::arg(#res "_" #line "_avg10",  res.line.avg10), \
+            fmt::arg(#res "_" #line "_avg60",  res.line.avg60), \
+            fmt::arg(#res "_" #line "_avg300", res.line.avg300),\
+            fmt::arg(#res "_" #line "_total",  res.line.total)
+            FMT_PSI_LINE(cpu, some),
+            FMT_PSI_LINE(cpu, full),
+            FMT_PSI_LINE(memory, some),
+            FMT_PSI_LINE(memory, full),
+            FMT_PSI_LINE(io, some),
+            FMT_PSI_LINE(io, full)
+#undef  FMT_PSI_LINE
+        );
+
+        if (++i != cgroups.size()) {
+            *out = ' ';
+            ++out;
+        }
+    }
+
+    return out;
+}
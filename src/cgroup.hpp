@@ -0,0 +1,215 @@
+#ifndef  __swaystatus_cgroup_HPP__
+# define __swaystatus_cgroup_HPP__
+
+# include <cstddef>
+# include <cstdint>
+# include <string>
+# include <string_view>
+# include <vector>
+
+# include "Fd.hpp"
+# include "psi.hpp"
+
+# include "formatting/fmt_config.hpp"
+# include "formatting/fmt/include/fmt/format.h"
+
+namespace swaystatus {
+/**
+ * Cgroup reads resource usage of one cgroup v2 through fds opened once in open().
+ *
+ * All files except cpu.stat are optional, e.g. memory.max does not exist in the root cgroup
+ * and {cpu,memory,io}.pressure do not exist if the kernel is built without PSI.
+ */
+class Cgroup {
+public:
+    enum pressure_resource: std::uint8_t {
+        pressure_cpu,
+        pressure_memory,
+        pressure_io,
+        pressure_cnt,
+    };
+
+private:
+    /**
+     * Absolute path to the cgroup directory, ending with '/'
+     */
+    std::string path;
+
+    bool available = false;
+    /**
+     * Inotify watch descriptor of memory.events, -1 if not watched.
+     */
+    int wd = -1;
+
+    Fd memory_current_fd;
+    Fd memory_max_fd;
+    Fd memory_events_fd;
+    Fd cpu_stat_fd;
+    Fd pressure_fds[pressure_cnt];
+
+    /**
+     * @return -1 if the file does not exist
+     */
+    auto open_file(const char *filename) -> int;
+    void close() noexcept;
+
+    /**
+     * @return false if the cgroup is removed.
+     */
+    bool read_memory();
+    bool read_cpu(std::uint64_t elapsed_us);
+
+public:
+    std::uint64_t memory_current = 0;
+    /**
+     * 0 if there is no limit.
+     */
+    std::uint64_t memory_max = 0;
+    /**
+     * memory_current / memory_max in percentage, 0 if there is no limit.
+     */
+    std::uint8_t memory_percent = 0;
+
+    std::uint64_t oom_count = 0;
+    std::uint64_t oom_kill_count = 0;
+    /**
+     * true if oom or oom_kill in memory.events increased in the last update.
+     */
+    bool has_new_oom = false;
+
+    std::uint64_t usage_usec = 0;
+    std::uint64_t user_usec = 0;
+    std::uint64_t system_usec = 0;
+    /**
+     * Percentage of one cpu used since the last update, can exceed 100 on multi-core system.
+     */
+    std::uint32_t cpu_usage = 0;
+    std::uint32_t cpu_user_usage = 0;
+    std::uint32_t cpu_system_usage = 0;
+
+    psi_stats pressures[pressure_cnt];
+
+    /**
+     * @param path relative path is resolved against /sys/fs/cgroup/
+     */
+    Cgroup(std::string_view path);
+
+    Cgroup(Cgroup&&) = default;
+    Cgroup& operator = (Cgroup&&) = default;
+
+    ~Cgroup() = default;
+
+    /**
+     * (Re)open all files and add inotify watch of memory.events to inotify_fd.
+     *
+     * If the cgroup does not exist, it is marked as unavailable instead of failing.
+     *
+     * @param inotify_fd -1 to not watch memory.events
+     */
+    void open(int inotify_fd);
+
+    /**
+     * If the cgroup is removed, it is marked as unavailable.
+     *
+     * @param elapsed_us time elapsed since the last update, 0 for the first update
+     */
+    void update(std::uint64_t elapsed_us);
+
+    /**
+     * Called on IN_IGNORED, which is generated once memory.events is gone, e.g. the cgroup
+     * is removed.
+     *
+     * @return true if removed_wd is the watch of this cgroup, which is then marked as
+     *         unavailable.
+     */
+    bool handle_watch_removed(int removed_wd) noexcept;
+
+    bool is_available() const noexcept;
+    auto get_path() const noexcept -> std::string_view;
+    /**
+     * @return last component of path
+     */
+    auto get_name() const noexcept -> std::string_view;
+};
+
+class Cgroups {
+    std::vector<Cgroup> cgroups;
+
+    /**
+     * Becomes readable when memory.events of any cgroup is modified.
+     */
+    Fd inotify_fd;
+
+    std::uint64_t timestamp = 0;
+
+    std::uint8_t max_memory_percent = 0;
+    std::uint64_t oom_kill_count = 0;
+    bool has_new_oom = false;
+
+public:
+    using const_iterator = typename std::vector<Cgroup>::const_iterator;
+
+    /**
+     * @param paths NULL-terminated array
+     * @param watch_events true to create an inotify fd watching memory.events
+     */
+    Cgroups(const char * const *paths, bool watch_events);
+
+    Cgroups(Cgroups&&) = default;
+    Cgroups& operator = (Cgroups&&) = default;
+
+    ~Cgroups() = default;
+
+    /**
+     * @return -1 if memory.events is not watched
+     */
+    int get_inotify_fd() const noexcept;
+    /**
+     * Drain inotify_fd.
+     *
+     * @return true if memory.events of any cgroup is modified or removed.
+     */
+    bool handle_notifications();
+
+    /**
+     * Cgroups that are unavailable are reopened instead, so that a cgroup created or
+     * recreated after open() is picked up.
+     */
+    void update();
+    /**
+     * Reopen all cgroups, e.g. after a cgroup is removed and recreated.
+     */
+    void reload();
+
+    auto get_max_memory_percent() const noexcept -> std::uint8_t;
+    /**
+     * @return sum of oom_kill of all cgroups
+     */
+    auto get_oom_kill_count() const noexcept -> std::uint64_t;
+    /**
+     * @return true if any cgroup has_new_oom
+     */
+    bool get_has_new_oom() const noexcept;
+
+    auto size() const noexcept -> std::size_t;
+
+    auto begin() const noexcept -> const_iterator;
+    auto end() const noexcept -> const_iterator;
+};
+} /* namespace swaystatus */
+
+template <>
+struct fmt::formatter<swaystatus::Cgroups>
+{
+    using Cgroups = swaystatus::Cgroups;
+
+    using format_parse_context_it = typename format_parse_context::iterator;
+    using format_context_it = typename format_context::iterator;
+
+    std::string_view fmt_str = "";
+
+    auto parse(format_parse_context &ctx) -> format_parse_context_it;
+    auto format(const Cgroups &cgroups, format_context &ctx) -> format_context_it;
+};
+
+#endif
@@ -59,4 +59,25 @@ ssize_t asreadall(int fd, std::string &buffer)
 
     return bytes;
 }
+ssize_t aspreadall(int fd, std::vector<char> &buffer)
+{
+    size_t bytes = 0;
+    for (;;) {
+        if (buffer.size() - bytes == 1)
+            buffer.resize(buffer.size() * 2);
+
+        ssize_t ret = pread(fd, buffer.data() + bytes, buffer.size() - 1 - bytes, bytes);
+        if (ret == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (ret == 0)
+            break;
+        bytes += ret;
+    }
+    buffer[bytes] = '\0';
+
+    return bytes;
+}
 } /* namespace swaystatus */
@@ -0,0 +1,279 @@
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>     /* For O_RDONLY */
+#include <unistd.h>    /* For pread */
+#include <dirent.h>
+
+#include <cstring>
+#include <utility>
+
+#include "utility.h"
+#include "mem_size_t.hpp"
+#include "sparkline.hpp"
+#include "formatting/fmt_utility.hpp"
+#include "formatting/LazyEval.hpp"
+#include "diskstats.hpp"
+
+namespace swaystatus {
+static constexpr const char *diskstats_path = "/proc/diskstats";
+
+/**
+ * Sectors in /proc/diskstats are always 512 bytes regardless of the device.
+ */
+static constexpr const std::uint64_t sector_size = 512;
+
+
+/**
+ * Parse the fields after the device name.
+ */
+static auto parse_disk_stat(char *p, disk_stat &stat) noexcept -> char*
+{
+    std::uint64_t unused;
+
+    p = parse_uint(p, &stat.reads);
+    p = parse_uint(p, &unused);             /* reads merged */
+    p = parse_uint(p, &stat.read_sectors);
+    p = parse_uint(p, &unused);             /* time spent reading */
+    p = parse_uint(p, &stat.writes);
+    p = parse_uint(p, &unused);             /* writes merged */
+    p = parse_uint(p, &stat.write_sectors);
+    p = parse_uint(p, &unused);             /* time spent writing */
+    p = parse_uint(p, &unused);             /* I/Os currently in progress */
+    p = parse_uint(p, &stat.io_ticks);
+
+    return p;
+}
+
+/**
+ * @return 0 if counter goes backwards
+ */
+static auto get_rate(std::uint64_t prev, std::uint64_t curr, std::uint64_t elapsed) noexcept
+    -> std::uint64_t
+{
+    if (curr < prev)
+        return 0;
+    return (curr - prev) * 1000 * 1000 * 1000 / elapsed;
+}
+
+/**
+ * @return true if /sys/block/<name> exists and has no slaves.
+ */
+static bool is_physical_disk(std::string_view name)
+{
+    std::string path = "/sys/block/";
+    // '/' in device names is replaced with '!' in sysfs, e.g. cciss/c0d0
+    for (char c: name)
+        path.push_back(c == '/' ? '!' : c);
+    path += "/slaves";
+
+    // Partitions are not present in /sys/block
+    DIR *dir = opendir(path.c_str());
+    if (!dir)
+        return false;
+
+    bool has_slaves = false;
+    for (struct dirent *ent; !has_slaves && (ent = readdir(dir)); )
+        has_slaves = std::strcmp(ent->d_name, ".") != 0 && std::strcmp(ent->d_name, "..") != 0;
+
+    closedir(dir);
+    return !has_slaves;
+}
+
+Disk::Disk(std::string_view name, std::size_t window):
+    name{name},
+    is_physical{is_physical_disk(name)},
+    read_bytes_history{window},
+    write_bytes_history{window}
+{}
+
+Disks::Disks(NameFilter &&filter, std::size_t rate_window):
+    diskstats_fd{openat_checked("", AT_FDCWD, diskstats_path, O_RDONLY)},
+    filter{std::move(filter)},
+    rate_window{rate_window}
+{}
+
+std::size_t Disks::read_diskstats()
+{
+    ssize_t len = aspreadall(diskstats_fd.get(), buffer);
+    if (len == -1)
+        err(1, "%s on %s failed", "pread", diskstats_path);
+
+    return len;
+}
+
+auto Disks::find_or_add_disk(std::size_t i, std::string_view name) -> Disk&
+{
+    using std::swap;
+
+    if (i < disks.size() && disks[i].name == name)
+        return disks[i];
+
+    for (std::size_t j = i + 1; j < disks.size(); ++j) {
+        if (disks[j].name == name) {
+            swap(disks[i], disks[j]);
+            return disks[i];
+        }
+    }
+
+    return *disks.emplace(disks.begin() + i, name, rate_window);
+}
+
+void Disks::update()
+{
+    const auto len = read_diskstats();
+
+    const auto now = get_monotonic_timestamp();
+    const auto elapsed = timestamp == 0 ? 0 : now - timestamp;
+    timestamp = now;
+
+    total_rates = disk_rates{};
+
+    std::size_t cnt = 0;
+
+    char *p = buffer.data();
+    char * const end = buffer.data() + len;
+    while (p != end) {
+        std::uint64_t major, minor;
+        p = parse_uint(p, &major);
+        p = parse_uint(p, &minor);
+        while (*p == ' ')
+            ++p;
+
+        char *name = p;
+        while (*p != ' ' && *p != '\n' && *p != '\0')
+            ++p;
+
+        if (*p == ' ') {
+            *p++ = '\0';
+
+            if (filter.matches(name)) {
+                const std::string_view name_sv{name, static_cast<std::size_t>(p - 1 - name)};
+
+                auto &disk = find_or_add_disk(cnt, name_sv);
+                ++cnt;
+
+                const auto prev_stat = disk.stat;
+                p = parse_disk_stat(p, disk.stat);
+
+                auto &rates = disk.rates;
+                // A new disk has no previous stat
+                if (elapsed != 0 && prev_stat.io_ticks + prev_stat.reads + prev_stat.writes != 0) {
+                    rates.read_bytes = get_rate(prev_stat.read_sectors, disk.stat.read_sectors, elapsed)
+                        * sector_size;
+                    rates.write_bytes = get_rate(prev_stat.write_sectors, disk.stat.write_sectors, elapsed)
+                        * sector_size;
+                    rates.read_iops = get_rate(prev_stat.reads, disk.stat.reads, elapsed);
+                    rates.write_iops = get_rate(prev_stat.writes, disk.stat.writes, elapsed);
+
+                    // io_ticks is in ms
+                    auto util = get_rate(prev_stat.io_ticks, disk.stat.io_ticks, elapsed) / 10;
+                    rates.util = static_cast<std::uint8_t>(util > 100 ? 100 : util);
+                } else
+                    rates = disk_rates{};
+
+                disk.read_bytes_history.push(rates.read_bytes);
+                disk.write_bytes_history.push(rates.write_bytes);
+
+                if (disk.is_physical) {
+                    total_rates.read_bytes += rates.read_bytes;
+                    total_rates.write_bytes += rates.write_bytes;
+                    total_rates.read_iops += rates.read_iops;
+                    total_rates.write_iops += rates.write_iops;
+                }
+                if (rates.util > total_rates.util)
+                    total_rates.util = rates.util;
+            }
+        }
+
+        void *newline = std::memchr(p, '\n', end - p);
+        if (!newline)
+            break;
+        p = static_cast<char*>(newline) + 1;
+    }
+
+    // Disks removed are moved to the end by find_or_add_disk
+    disks.erase(disks.begin() + cnt, disks.end());
+}
+
+auto Disks::get_total_rates() const noexcept -> const disk_rates&
+{
+    return total_rates;
+}
+
+auto Disks::size() const noexcept -> std::size_t
+{
+    return disks.size();
+}
+auto Disks::begin() const noexcept -> const_iterator
+{
+    return disks.begin();
+}
+auto Disks::end() const noexcept -> const_iterator
+{
+    return disks.end();
+}
+} /* namespace swaystatus */
+
+using Disks_formatter = fmt::formatter<swaystatus::Disks>;
+
+auto Disks_formatter::parse(format_parse_context &ctx) -> format_parse_context_it
+{
+    auto it = ctx.begin(), end = ctx.end();
+    if (it == end)
+        return it;
+
+    end = swaystatus::find_end_of_format(ctx);
+
+    fmt_str = std::string_view{it, static_cast<std::size_t>(end - it)};
+
+    return end;
+}
+auto Disks_formatter::format(const Disks &disks, format_context &ctx) -> format_context_it
+{
+    using swaystatus::LazyEval;
+    using swaystatus::mem_size_t;
+    using swaystatus::sparkline;
+
+    auto out = ctx.out();
+
+    if (fmt_str.size() == 0)
+        return out;
+
+    std::size_t i = 0;
+    for (const auto &disk: disks) {
+        const auto &rates = disk.rates;
+
+        out = format_to(
+            out,
+            fmt_str,
+            fmt::arg("name", disk.name),
+
+            fmt::arg("read_bytes",  mem_size_t{disk.stat.read_sectors * swaystatus::sector_size}),
+            fmt::arg("write_bytes", mem_size_t{disk.stat.write_sectors * swaystatus::sector_size}),
+
+#define FMT_RATE_LAZY(history, func) \
+    LazyEval{[&disk]() noexcept { return mem_size_t{disk.history.func()}; }}
+#define FMT_RATE(name, attr, history)                               \
+            fmt::arg(name,        mem_size_t{rates.attr}),          \
+            fmt::arg(name "_min", FMT_RATE_LAZY(history, min)),     \
+            fmt::arg(name "_max", FMT_RATE_LAZY(history, max)),     \
+            fmt::arg(name "_avg", FMT_RATE_LAZY(history, avg)),     \
+            fmt::arg(name "_sparkline", sparkline{disk.history})
+            FMT_RATE("read_rate",  read_bytes,  read_bytes_history),
+            FMT_RATE("write_rate", write_bytes, write_bytes_history),
+#undef  FMT_RATE
+#undef  FMT_RATE_LAZY
+
+            fmt::arg("read_iops",  rates.read_iops),
+            fmt::arg("write_iops", rates.write_iops),
+            fmt::arg("util",       rates.util)
+        );
+
+        if (++i != disks.size()) {
+            *out = ' ';
+            ++out;
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,145 @@
+#ifndef  __swaystatus_diskstats_HPP__
+# define __swaystatus_diskstats_HPP__
+
+# include <cstddef>
+# include <cstdint>
+# include <string>
+# include <string_view>
+# include <vector>
+
+# include "Fd.hpp"
+# include "NameFilter.hpp"
+# include "RingBuffer.hpp"
+
+# include "formatting/fmt_config.hpp"
+# include "formatting/fmt/include/fmt/format.h"
+
+namespace swaystatus {
+/**
+ * Counters of one line of /proc/diskstats that are used.
+ */
+struct disk_stat {
+    std::uint64_t reads = 0;
+    std::uint64_t read_sectors = 0;
+    std::uint64_t writes = 0;
+    std::uint64_t write_sectors = 0;
+    /**
+     * Time spent doing I/O in ms
+     */
+    std::uint64_t io_ticks = 0;
+};
+
+/**
+ * Per second
+ */
+struct disk_rates {
+    std::uint64_t read_bytes = 0;
+    std::uint64_t write_bytes = 0;
+    std::uint64_t read_iops = 0;
+    std::uint64_t write_iops = 0;
+    /**
+     * Percentage of time spent doing I/O
+     */
+    std::uint8_t util = 0;
+};
+
+struct Disk {
+    std::string name;
+
+    /**
+     * true if it is a whole disk not stacked on other disks, only these are summed up
+     * in total rates since partitions, dm and md devices are already counted in the
+     * disks under them.
+     */
+    bool is_physical;
+
+    disk_stat stat;
+    disk_rates rates;
+
+    RingBuffer<std::uint64_t> read_bytes_history;
+    RingBuffer<std::uint64_t> write_bytes_history;
+
+    /**
+     * @param window number of samples to keep, must not be 0
+     */
+    Disk(std::string_view name, std::size_t window);
+};
+
+/**
+ * Disks parses /proc/diskstats in one pass through a persistent fd.
+ *
+ * Devices filtered out are skipped before their counters are parsed.
+ */
+class Disks {
+    Fd diskstats_fd;
+    /**
+     * It only grows when /proc/diskstats is larger than ever seen.
+     */
+    std::vector<char> buffer = std::vector<char>(4096);
+
+    NameFilter filter;
+    std::size_t rate_window;
+
+    /**
+     * In the same order as /proc/diskstats
+     */
+    std::vector<Disk> disks;
+
+    std::uint64_t timestamp = 0;
+
+    disk_rates total_rates;
+
+    /**
+     * @return length of content read
+     */
+    std::size_t read_diskstats();
+
+    /**
+     * @param i index the disk is expected to be at
+     * @return the disk named name, which is moved to i if it is found elsewhere, or
+     *         inserted if it is a new disk.
+     */
+    auto find_or_add_disk(std::size_t i, std::string_view name) -> Disk&;
+
+public:
+    using const_iterator = typename std::vector<Disk>::const_iterator;
+
+    /**
+     * @param rate_window number of samples of rates to keep, must not be 0
+     */
+    Disks(NameFilter &&filter, std::size_t rate_window);
+
+    Disks(Disks&&) = default;
+    Disks& operator = (Disks&&) = default;
+
+    ~Disks() = default;
+
+    void update();
+
+    /**
+     * @return rates summed up over all physical disks, util is the highest one of all disks.
+     */
+    auto get_total_rates() const noexcept -> const disk_rates&;
+
+    auto size() const noexcept -> std::size_t;
+
+    auto begin() const noexcept -> const_iterator;
+    auto end() const noexcept -> const_iterator;
+};
+} /* namespace swaystatus */
+
+template <>
+struct fmt::formatter<swaystatus::Disks>
+{
+    using Disks = swaystatus::Disks;
+
+    using format_parse_context_it = typename format_parse_context::iterator;
+    using format_context_it = typename format_context::iterator;
+
+    std::string_view fmt_str = "";
+
+    auto parse(format_parse_context &ctx) -> format_parse_context_it;
+    auto format(const Disks &disks, format_context &ctx) -> format_context_it;
+};
+
+#endif
@@ -6,7 +6,7 @@
 #include "fmt_config.hpp"
 
 namespace swaystatus {
-static const char *module = nullptr;
+static thread_local const char *module = nullptr;
 void fmt_set_calling_module(const char *module_arg) noexcept
 {
     (void) module_arg;
@@ -4,13 +4,21 @@
 #include <err.h>
 
 #include <algorithm>
+#include <string>
 
 #include "fmt/include/fmt/format.h"
 
 #include "../utility.h"
 #include "printer.hpp"
 
-static fmt::basic_memory_buffer<char, /* Inline buffer size */ 4096> out;
+/**
+ * Per thread, so that blocks can be rendered in worker threads.
+ */
+static thread_local fmt::basic_memory_buffer<char, /* Inline buffer size */ 4096> out;
+/**
+ * Size of out before the last reserve_print_buffer()
+ */
+static thread_local size_t reserved_at;
 
 extern "C" {
 void print_str(const char *str)
@@ -50,4 +58,56 @@ void vprint(fmt::string_view format, fmt::format_args args)
 {
     fmt::vformat_to(out, format, args);
 }
+auto reserve_print_buffer(std::size_t n) -> char*
+{
+    reserved_at = out.size();
+    out.resize(reserved_at + n);
+    return out.data() + reserved_at;
+}
+void commit_print_buffer(std::size_t len)
+{
+    static constexpr const char hex[] = "0123456789abcdef";
+
+    auto is_control = [](unsigned char c) noexcept
+    {
+        return c < 0x20;
+    };
+
+    size_t extra = 0;
+    for (size_t i = reserved_at; i != reserved_at + len; ++i) {
+        unsigned char c = out[i];
+        if (c == '"' || c == '\\')
+            extra += 1;
+        else if (is_control(c))
+            extra += sizeof("\\u0000") - 2;
+    }
+
+    out.resize(reserved_at + len + extra);
+    if (extra == 0)
+        return;
+
+    // Expand from the end, so that no byte is overwritten before it is read.
+    auto *data = out.data();
+    auto *dest = data + reserved_at + len + extra;
+    for (auto *src = data + reserved_at + len; src != data + reserved_at; ) {
+        unsigned char c = *--src;
+        if (c == '"' || c == '\\') {
+            *--dest = c;
+            *--dest = '\\';
+        } else if (is_control(c)) {
+            *--dest = hex[c & 0xf];
+            *--dest = hex[c >> 4];
+            *--dest = '0';
+            *--dest = '0';
+            *--dest = 'u';
+            *--dest = '\\';
+        } else
+            *--dest = c;
+    }
+}
+void take_buffer(std::string &str)
+{
+    str.append(out.data(), out.size());
+    out.clear();
+}
 } /* End of namespace swaystatus */
@@ -36,6 +36,8 @@ void flush();
 # endif
 
 # ifdef __cplusplus
+#  include <cstddef>
+#  include <string>
 #  include <string_view>
 
 namespace swaystatus {
@@ -60,12 +62,12 @@ inline void print_str2(std::string_view sv)
 }
 
 /**
- * Prints to the buffer of stdout, but does not flush the buffer, not thread safe.
+ * Prints to the buffer of stdout of the calling thread, but does not flush the buffer.
  */
 void vprint(fmt::string_view format, fmt::format_args args);
 
 /**
- * Prints to the buffer of stdout, but does not flush the buffer, not thread safe.
+ * Prints to the buffer of stdout of the calling thread, but does not flush the buffer.
  */
 template <typename S, typename ...Args>
 void print(const S &format, Args &&...args)
@@ -73,6 +75,27 @@ void print(const S &format, Args &&...args)
     swaystatus::vprint(format, fmt::make_args_checked<Args...>(format, args...));
 }
 
+/**
+ * Extend the buffer of the calling thread by n bytes to be written directly, which must be
+ * followed by commit_print_buffer() before anything else is printed.
+ *
+ * @return the bytes added
+ */
+auto reserve_print_buffer(std::size_t n) -> char*;
+/**
+ * Keep the first len bytes written to the area returned by reserve_print_buffer() and
+ * escape them in place, so that they can be put in a JSON string.
+ *
+ * @param len must not be greater than n passed to reserve_print_buffer().
+ */
+void commit_print_buffer(std::size_t len);
+
+/**
+ * Append the buffer of the calling thread to str and clear it, used by threads other than
+ * the main one, whose buffer is never flushed.
+ */
+void take_buffer(std::string &str);
+
 /**
  * Flush the buffer of stdout, not thread safe.
  */
@@ -7,12 +7,16 @@
 #include <json_tokener.h>
 
 #include <algorithm>
+#include <memory>
+#include <string>
 #include <variant>
 #include <tuple>
 
 #include "poller.h"
 #include "utility.h"
+#include "process_configuration.h"
 #include "Callback/Callable.hpp"
+#include "Callback/async_thread.hpp"
 #include "handle_click_events.h"
 
 extern "C" {
@@ -29,6 +33,23 @@ std::tuple<std::uint64_t, std::uint64_t> to_unpackable(const struct Pos &pos)
     return {pos.x, pos.y};
 }
 
+struct Callback;
+
+/**
+ * Copy of a click event queued to the async thread.
+ */
+struct AsyncClickEvent {
+    Callback *callback;
+
+    bool has_instance;
+    std::string instance;
+    ClickPos pos;
+    std::uint64_t button;
+    std::uint64_t event;
+    ClickPos relative_pos;
+    BlockSize size;
+};
+
 struct Callback {
     const char *name;
     swaystatus::Callable</* Ret type */ std::uint8_t,
@@ -40,7 +61,26 @@ struct Callback {
         const ClickPos &,
         const BlockSize &
     > callable;
+    /**
+     * Updated atomically since async handlers run in another thread.
+     */
     std::uint8_t requested_events = 0;
+    /**
+     * If set, the handler is queued to the async thread instead of called inline.
+     */
+    bool is_async = false;
+
+    static void call_async(void *data)
+    {
+        std::unique_ptr<AsyncClickEvent> e{static_cast<AsyncClickEvent*>(data)};
+        auto &callback = *e->callback;
+
+        auto requests = callback.callable(
+            e->has_instance ? e->instance.c_str() : nullptr,
+            e->pos, e->button, e->event, e->relative_pos, e->size
+        );
+        __atomic_fetch_or(&callback.requested_events, requests, __ATOMIC_RELEASE);
+    }
 
     auto operator () (
         const char *instance,
@@ -51,7 +91,18 @@ struct Callback {
         const BlockSize &size
     )
     {
-        requested_events |= callable(instance, pos, button, event, relative_pos, size);
+        if (is_async) {
+            auto *e = new AsyncClickEvent{
+                this,
+                instance != nullptr, instance ? instance : "",
+                pos, button, event, relative_pos, size
+            };
+            swaystatus::submit_async(call_async, e);
+            return;
+        }
+
+        auto requests = callable(instance, pos, button, event, relative_pos, size);
+        __atomic_fetch_or(&requested_events, requests, __ATOMIC_RELEASE);
     }
 };
 
@@ -77,7 +128,11 @@ uint8_t* add_click_event_handler(const char *name, const void *click_event_handl
     auto &callback = callbacks[callback_cnt++];
 
     callback.name = name;
-    callback.callable = swaystatus::Callable_base(name, click_event_handler_config);
+    swaystatus::CallableInterpreter interpreter{
+        get_bool_property(click_event_handler_config, name, "subinterpreter", false)
+    };
+    callback.callable = swaystatus::Callable_base(name, click_event_handler_config, &interpreter);
+    callback.is_async = get_bool_property(click_event_handler_config, name, "async", false);
 
     if (parser == nullptr) {
         parser = json_tokener_new();
@@ -4,7 +4,7 @@
 # include <stddef.h>
 # include <stdint.h>
 
-# define CALLBACK_CNT 12
+# define CALLBACK_CNT 17
 
 # ifdef __cplusplus
 extern "C" {
@@ -30,6 +30,7 @@ void init_click_events_handling();
  *              requested by the callback (a bitwise or of all return value)
  * 
  * Be sure to set the *(ret ptr) to 0 after you processed all events in it.
+ * Since async handlers update it in another thread, use __atomic_exchange_n to do so.
  */
 uint8_t* add_click_event_handler(const char *name, const void *click_event_handler_config);
 
@@ -68,6 +68,11 @@ public:
         backlights.clear();
         load();
     }
+
+    bool can_update_off_thread() const noexcept
+    {
+        return true;
+    }
 };
 
 std::unique_ptr<Base> makeBacklightPrinter(void *config)
@@ -4,10 +4,17 @@
 #include <cstring>
 
 #include <algorithm>
+#include <atomic>
+#include <string>
 
+#include "../utility.h"
 #include "../error_handling.hpp"
 #include "../process_configuration.h"
 #include "../handle_click_events.h"
+#include "../poller.h"
+#include "../worker_pool.hpp"
+#include "../TripleBuffer.hpp"
+#include "../Callback/async_thread.hpp"
 #include "../formatting/printer.hpp"
 
 #include "Base.hpp"
@@ -21,10 +28,107 @@
 #include "TimePrinter.hpp"
 #include "VolumePrinter.hpp"
 #include "CustomPrinter.hpp"
+#include "CpuUsagePrinter.hpp"
+#include "PressurePrinter.hpp"
+#include "CgroupPrinter.hpp"
+#include "DiskUsagePrinter.hpp"
+#include "DiskIOPrinter.hpp"
+#include "ProcessesPrinter.hpp"
+#include "WatchedProcessesPrinter.hpp"
+#include "PluginPrinter.hpp"
 
 using namespace std::literals;
 
 namespace swaystatus::modules {
+struct Base::Offloaded {
+    struct Snapshot {
+        /**
+         * full_text and short_text printed by print_text()
+         */
+        std::string text;
+        bool urgent = false;
+        /**
+         * Set if the update finished after the deadline.
+         */
+        bool is_late = false;
+    };
+    TripleBuffer<Snapshot> snapshots;
+
+    /**
+     * In ns, 0 if disabled.
+     */
+    std::uint64_t deadline = 0;
+    /**
+     * "color" of the block when the deadline is missed, can be nullptr.
+     */
+    std::unique_ptr<const char[]> stale_color;
+    /**
+     * "color" specified by user, can be nullptr.
+     * If deadline is set, it is taken out of user_specified_properties_str so that exactly
+     * one "color" is printed.
+     */
+    std::unique_ptr<const char[]> color;
+
+    /**
+     * Set by the main thread on submitting and cleared by the worker once the snapshot is
+     * published.
+     */
+    std::atomic<bool> is_busy{false};
+
+    /**
+     * Requests (ClickHandlerRequest) not submitted yet, only accessed by the main thread.
+     */
+    std::uint8_t pending = 0;
+    /**
+     * Requests of the update submitted, written by the main thread before submitting.
+     */
+    std::uint8_t requests = 0;
+    /**
+     * Timestamp of the update submitted, written by the main thread before submitting.
+     */
+    std::uint64_t submitted_at = 0;
+
+    /**
+     * Number of consecutive late updates, only accessed by the main thread.
+     */
+    std::uint8_t late_cnt = 0;
+    /**
+     * Number of updates due to be skipped, only accessed by the main thread.
+     */
+    std::uint32_t backoff_cnt = 0;
+};
+
+/**
+ * After n consecutive late updates, the interval is multiplied by 2^min(n, max_backoff_shift).
+ */
+static constexpr const std::uint8_t max_backoff_shift = 6;
+
+static bool is_hex_digit(char c) noexcept
+{
+    return ('0' <= c && c <= '9') || ('a' <= c && c <= 'f') || ('A' <= c && c <= 'F');
+}
+/**
+ * @return true if color is in the form of #RRGGBB or #RRGGBBAA, as swaybar expects.
+ */
+static bool is_valid_color(const char *color) noexcept
+{
+    if (*color++ != '#')
+        return false;
+
+    std::size_t len = 0;
+    for (; is_hex_digit(*color); ++color)
+        ++len;
+
+    return *color == '\0' && (len == 6 || len == 8);
+}
+
+/**
+ * Created in makeModules() if any module is blocking.
+ * It is never freed since modules are never destroyed either.
+ */
+static WorkerPool *worker_pool;
+static constexpr const std::size_t max_worker_threads = 4;
+
 Base::Base(
     void *config, std::string_view module_name_arg,
     std::uint32_t default_interval,
@@ -35,10 +139,33 @@ Base::Base(
     full_text_format{get_format(config, default_full_format)},
     short_text_format{get_short_format(config, default_short_format)},
     interval{get_update_interval(config, module_name_arg.data(), default_interval)},
-    requested_events{add_click_event_handler(module_name.data(), get_click_event_handler(config))}
+    requested_events{add_click_event_handler(module_name.data(), get_click_event_handler(config))},
+    offloaded{get_blocking(config, module_name_arg.data()) ? new Offloaded{} : nullptr}
 {
     this->cycle_cnt = interval - 1;
 
+    const auto *name = module_name.data();
+    const auto deadline = get_uint_property(config, name, "deadline", 0);
+    std::unique_ptr<const char[]> stale_color{get_property(config, "stale_color", nullptr)};
+
+    if (stale_color && !is_valid_color(stale_color.get()))
+        errx(1, "%s on %s.%s%s", "Invalid value", name, "stale_color", "");
+
+    if (offloaded) {
+        offloaded->deadline = static_cast<std::uint64_t>(deadline) * 1000 * 1000;
+        offloaded->stale_color = std::move(stale_color);
+
+        if (deadline != 0) {
+            offloaded->color.reset(get_property(config, "color", nullptr));
+            if (offloaded->color && !is_valid_color(offloaded->color.get()))
+                errx(1, "%s on %s.%s%s", "Invalid value", name, "color", "");
+            remove_property(config, "color");
+        }
+    } else if (deadline != 0 || stale_color) {
+        errx(1, "%s on %s.%s%s",
+                "\"blocking\" is required", name, deadline != 0 ? "deadline" : "stale_color", "");
+    }
+
     std::va_list ap;
     va_start(ap, n);
     user_specified_properties_str.reset(get_user_specified_property_str_impl2(config, n, ap));
@@ -47,40 +174,194 @@ Base::Base(
     va_end(ap);
 }
 
-void Base::update_and_print()
+static bool immediate_update_requested;
+
+bool consume_immediate_update_request() noexcept
 {
-    if (requested_events) {
-        const ClickHandlerRequest requests{*requested_events};
-        *requested_events = static_cast<std::uint8_t>(ClickHandlerRequest::none);
+    // Jobs of submit_async() might publish results or click requests.
+    bool requested = immediate_update_requested | consume_async_done();
+    immediate_update_requested = false;
+    return requested;
+}
 
+Base::~Base() = default;
+
+static void on_worker_notification(int fd, enum Event events, void *data)
+{
+    (void) fd;
+    (void) events;
+    (void) data;
+
+    worker_pool->consume_notification();
+    // Print the snapshots published and submit updates requested while they were running.
+    immediate_update_requested = true;
+}
+
+auto Base::consume_click_requests() noexcept -> std::uint8_t
+{
+    if (!requested_events)
+        return static_cast<std::uint8_t>(ClickHandlerRequest::none);
+
+    // Async click handlers set it in another thread.
+    return __atomic_exchange_n(
+        requested_events, static_cast<std::uint8_t>(ClickHandlerRequest::none), __ATOMIC_ACQUIRE
+    );
+}
+bool Base::is_update_due(bool is_tick) noexcept
+{
+    if (is_tick && ++cycle_cnt == interval) {
+        cycle_cnt = 0;
+        update_requested = false;
+        return true;
+    } else if (update_requested) {
+        update_requested = false;
+        return true;
+    }
+    return false;
+}
+
+void Base::submit_update(std::uint8_t requests)
+{
+    auto &o = *offloaded;
+
+    o.pending |= requests;
+    if (o.pending == 0 || o.is_busy.load(std::memory_order_acquire))
+        return;
+
+    o.requests = o.pending;
+    o.pending = 0;
+    o.submitted_at = get_monotonic_timestamp();
+    o.is_busy.store(true, std::memory_order_relaxed);
+
+    worker_pool->submit(update_off_thread, this);
+}
+void Base::update_off_thread(void *p)
+{
+    auto *self = static_cast<Base*>(p);
+    auto &o = *self->offloaded;
+
+    const ClickHandlerRequest requests{o.requests};
+    if (requests & ClickHandlerRequest::reload)
+        self->reload();
+    self->update();
+
+    auto &snapshot = o.snapshots.get_back();
+    snapshot.text.clear();
+    self->print_text();
+    take_buffer(snapshot.text);
+    snapshot.urgent = self->urgent;
+    snapshot.is_late = o.deadline != 0 && get_monotonic_timestamp() - o.submitted_at > o.deadline;
+    o.snapshots.publish();
+
+    o.is_busy.store(false, std::memory_order_release);
+    worker_pool->notify();
+}
+
+void Base::update_and_print(bool is_tick)
+{
+    const ClickHandlerRequest requests{consume_click_requests()};
+
+    bool is_urgent;
+    bool is_stale = false;
+    if (offloaded) {
+        auto &o = *offloaded;
+
+        std::uint8_t pending = static_cast<std::uint8_t>(requests);
+        if (is_update_due(is_tick)) {
+            if (o.backoff_cnt != 0)
+                --o.backoff_cnt;
+            else
+                pending |= static_cast<std::uint8_t>(ClickHandlerRequest::update);
+        }
+        submit_update(pending);
+
+        if (o.snapshots.update_front()) {
+            if (o.snapshots.get_front().is_late) {
+                if (o.late_cnt != max_backoff_shift)
+                    ++o.late_cnt;
+                o.backoff_cnt = (std::uint32_t{1} << o.late_cnt) - 1;
+            } else
+                o.late_cnt = 0;
+        }
+
+        // The update in flight has missed its deadline, so the snapshot printed is stale.
+        is_stale = o.deadline != 0 && o.is_busy.load(std::memory_order_acquire) &&
+                   get_monotonic_timestamp() - o.submitted_at > o.deadline;
+        is_urgent = o.snapshots.get_front().urgent || is_stale;
+    } else {
         if (requests & ClickHandlerRequest::reload) {
             reload();
             update();
         }
         if (requests & ClickHandlerRequest::update)
             update();
-    }
 
-    if (++cycle_cnt == interval) {
-        cycle_cnt = 0;
-        update();
+        if (is_update_due(is_tick))
+            update();
+        is_urgent = urgent;
     }
 
     print_literal_str("{\"name\":\"");
     print_str2(module_name);
     print_literal_str("\",\"instance\":\"0\",");
 
-    print_fmt("full_text"sv, full_text_format.get());
-    if (short_text_format)
-        print_fmt("short_text"sv, short_text_format.get());
+    if (offloaded) {
+        const auto &text = offloaded->snapshots.get_front().text;
+        // Nothing is published until the first update is done.
+        if (text.empty())
+            print_literal_str("\"full_text\":\"\",");
+        else
+            print_str2(text);
+    } else
+        print_text();
+
+    if (is_urgent)
+        print_literal_str("\"urgent\":true,");
 
     if (user_specified_properties_str)
         print_str2(user_specified_properties_str.get(), user_specified_properties_str_len);
     else
         print_literal_str("\"separator\":true");
 
+    if (offloaded && offloaded->deadline != 0) {
+        const char *color = is_stale && offloaded->stale_color ?
+            offloaded->stale_color.get() : offloaded->color.get();
+        if (color) {
+            print_literal_str(",\"color\":\"");
+            print_str(color);
+            print_literal_str("\"");
+        }
+    }
+
     print_literal_str("},");
 }
+void Base::request_update() noexcept
+{
+    update_requested = true;
+}
+void Base::request_immediate_update() noexcept
+{
+    update_requested = true;
+    immediate_update_requested = true;
+}
+void Base::set_urgent(bool urgent_arg) noexcept
+{
+    urgent = urgent_arg;
+}
+bool Base::is_blocking() const noexcept
+{
+    return offloaded != nullptr;
+}
+bool Base::can_update_off_thread() const noexcept
+{
+    return false;
+}
+void Base::print_text()
+{
+    print_fmt("full_text"sv, full_text_format.get());
+    if (short_text_format)
+        print_fmt("short_text"sv, short_text_format.get());
+}
 void Base::print_fmt(std::string_view name, const char *format)
 {
     print_literal_str("\"");
@@ -109,6 +390,14 @@ static constexpr const char * const default_order[] = {
     "time",
     "volume",
     "custom",
+    "cpu_usage",
+    "pressure",
+    "cgroup",
+    "disk_usage",
+    "disk_io",
+    "processes",
+    "watched_processes",
+    "plugin",
 };
 static constexpr auto default_order_len = sizeof(default_order) / sizeof(const char*);
 static_assert(CALLBACK_CNT >= default_order_len);
@@ -126,6 +415,9 @@ static constexpr const std::size_t default_index[] = {
 static constexpr auto default_index_len = sizeof(default_index) / sizeof(std::size_t);
 static_assert(default_order_len >= default_index_len);
 
+/**
+ * Factory returns nullptr if the module is disabled since a library it needs is not available.
+ */
 using Factory = std::unique_ptr<Base> (*)(void *config);
 static constexpr const Factory factories[] = {
     makeBacklightPrinter,
@@ -137,6 +429,14 @@ static constexpr const Factory factories[] = {
     makeTimePrinter,
     makeVolumePrinter,
     makeCustomPrinter,
+    makeCpuUsagePrinter,
+    makePressurePrinter,
+    makeCgroupPrinter,
+    makeDiskUsagePrinter,
+    makeDiskIOPrinter,
+    makeProcessesPrinter,
+    makeWatchedProcessesPrinter,
+    makePluginPrinter,
 };
 static_assert(default_order_len == sizeof(factories) / sizeof(Factory));
 
@@ -144,6 +444,7 @@ static auto makeModules(void *config, const std::size_t indexes[], std::size_t l
     -> std::vector<std::unique_ptr<Base>>
 {
     std::vector<std::unique_ptr<Base>> modules;
+    std::size_t blocking_cnt = 0;
 
     for (std::size_t i = 0; i != len; ++i) {
         auto index = indexes[i];
@@ -153,7 +454,22 @@ static auto makeModules(void *config, const std::size_t indexes[], std::size_t l
 
         Factory factory = factories[index];
         void *module_config = get_module_config(config, default_order[index]);
-        modules.push_back( factory(module_config) );
+        auto module = factory(module_config);
+        if (!module)
+            continue;
+
+        if (module->is_blocking()) {
+            if (!module->can_update_off_thread())
+                errx(1, "%s on %s.%s%s", "Not supported", default_order[index], "blocking", "");
+            ++blocking_cnt;
+        }
+
+        modules.push_back(std::move(module));
+    }
+
+    if (blocking_cnt != 0) {
+        worker_pool = new WorkerPool{std::min(blocking_cnt, max_worker_threads)};
+        request_polling(worker_pool->get_notification_fd(), read_ready, on_worker_notification, nullptr);
     }
 
     return modules; // C++17 guaranteed NRVO
@@ -49,12 +49,43 @@ class Base {
 
     std::uint8_t * const requested_events;
 
+    bool update_requested = false;
+    bool urgent = false;
+
+    /**
+     * State shared with the worker pool, non-null if "blocking" is set.
+     */
+    struct Offloaded;
+    std::unique_ptr<Offloaded> offloaded;
+
     // instance methods
 
     /**
      * @param name need to be null-terminated
      */
     void print_fmt(std::string_view name, const char *format);
+    /**
+     * Print full_text and short_text.
+     */
+    void print_text();
+
+    /**
+     * @return requests of click events, which are reset.
+     */
+    auto consume_click_requests() noexcept -> std::uint8_t;
+    /**
+     * @return true if update() should be called due to interval or request_update().
+     */
+    bool is_update_due(bool is_tick) noexcept;
+
+    /**
+     * Submit update to the worker pool if it is requested and the last one is done.
+     */
+    void submit_update(std::uint8_t requests);
+    /**
+     * Run in the worker pool, it calls update() and publishes a snapshot of printed text.
+     */
+    static void update_off_thread(void *self);
 
 protected:
     Base() = delete;
@@ -100,17 +131,53 @@ protected:
     virtual void do_print(const char *format) = 0;
     virtual void reload() = 0;
 
+    /**
+     * Make the next call to update_and_print() call update(), used by modules
+     * that are notified of changes through poller.
+     */
+    void request_update() noexcept;
+    /**
+     * Like request_update(), but also make all blocks printed as soon as the current
+     * round of polling is done instead of waiting for the next tick.
+     */
+    void request_immediate_update() noexcept;
+
+    /**
+     * Set "urgent" of the block, which is printed until set_urgent(false) is called.
+     */
+    void set_urgent(bool urgent) noexcept;
+
 public:
     /**
      * The first call to update_and_print will always trigger update
      * Immediately after reload(), update() will be called.
+     *
+     * @param is_tick false if it is called due to request_immediate_update(), in which
+     *                case update interval is not counted.
      */
-    void update_and_print();
+    void update_and_print(bool is_tick = true);
 
-    virtual ~Base() = default;
+    /**
+     * @return true if "blocking" is set, in which case update(), reload() and do_print()
+     *         are called in the worker pool and only the latest snapshot is printed.
+     */
+    bool is_blocking() const noexcept;
+    /**
+     * Override to return true if update(), reload() and do_print() only touch the state of
+     * this module and the module does not use poller, so that "blocking" can be set.
+     */
+    virtual bool can_update_off_thread() const noexcept;
+
+    virtual ~Base();
 };
 
 auto makeModules(void *config) -> std::vector<std::unique_ptr<Base>>;
+
+/**
+ * @return true if any module calls Base::request_immediate_update() since the last
+ *         call to this function.
+ */
+bool consume_immediate_update_request() noexcept;
 } /* namespace swaystatus::modules */
 
 #endif
@@ -8,6 +8,7 @@
 #include "../utility.h"
 #include "../process_configuration.h"
 #include "../Battery.hpp"
+#include "../native_views.hpp"
 
 #include "BatteryPrinter.hpp"
 
@@ -18,6 +19,8 @@ class BatteryPrinter: public Base {
     std::unique_ptr<const char[]> excluded_model;
     std::vector<Battery> batteries;
 
+    NativeView &view = *get_native_view("battery"sv);
+
     void load()
     {
         std::string_view excluded_model_sv;
@@ -64,6 +67,16 @@ public:
     {
         for (Battery &bat: batteries)
             bat.read_battery_uevent();
+
+        // Each uevent ends with '\n', so they are separated by empty lines.
+        view.publish([&](NativeSnapshot &snapshot)
+        {
+            snapshot.data.clear();
+            for (const Battery &bat: batteries) {
+                snapshot.data.append(bat.get_uevent());
+                snapshot.data.push_back('\n');
+            }
+        });
     }
     void do_print(const char *format)
     {
@@ -78,6 +91,11 @@ public:
         batteries.clear();
         load();
     }
+
+    bool can_update_off_thread() const noexcept
+    {
+        return true;
+    }
 };
 
 std::unique_ptr<Base> makeBatteryPrinter(void *config)
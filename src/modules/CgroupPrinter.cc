@@ -0,0 +1,82 @@
+#include <err.h>
+
+#include <utility>
+
+#include "../process_configuration.h"
+#include "../poller.h"
+#include "../formatting/Conditional.hpp"
+#include "../cgroup.hpp"
+
+#include "CgroupPrinter.hpp"
+
+using namespace std::literals;
+
+namespace swaystatus::modules {
+class CgroupPrinter: public Base {
+    Cgroups cgroups;
+
+    static void on_memory_events(int, enum Event events, void *data)
+    {
+        auto *self = static_cast<CgroupPrinter*>(data);
+
+        if (events & error)
+            errx(1, "%s on %s failed", "inotify fd", "CgroupPrinter");
+
+        if (self->cgroups.handle_notifications())
+            self->request_immediate_update();
+    }
+
+public:
+    CgroupPrinter(void *config, const char * const *paths, bool watch_oom):
+        Base{
+            config, "CgroupPrinter"sv,
+            5,
+            "{per_cgroup_fmt_str:"
+                "{name} {memory_current}{has_memory_max:/{memory_max}} CPU {cpu_usage}%"
+            "}",
+            "{per_cgroup_fmt_str:{name} {has_memory_max:{memory_percent}%}}",
+            "cgroups", "watch_oom"
+        },
+        cgroups{paths, watch_oom}
+    {
+        if (watch_oom)
+            request_polling(cgroups.get_inotify_fd(), read_ready, on_memory_events, this);
+    }
+
+    void update()
+    {
+        cgroups.update();
+        set_urgent(cgroups.get_has_new_oom());
+    }
+    void do_print(const char *format)
+    {
+        print(
+            format,
+            fmt::arg("cgroup_count",       cgroups.size()),
+            fmt::arg("max_memory_percent", cgroups.get_max_memory_percent()),
+            fmt::arg("oom_kill_count",     cgroups.get_oom_kill_count()),
+            fmt::arg("has_new_oom",        Conditional{cgroups.get_has_new_oom()}),
+
+            fmt::arg("per_cgroup_fmt_str", cgroups)
+        );
+    }
+    void reload()
+    {
+        cgroups.reload();
+    }
+};
+
+std::unique_ptr<Base> makeCgroupPrinter(void *config)
+{
+    auto watch_oom = get_bool_property(config, "CgroupPrinter", "watch_oom", true);
+
+    auto *paths = get_property_array(config, "CgroupPrinter", "cgroups");
+    if (!paths)
+        errx(1, "%s on %s.%s%s", "Missing property", "CgroupPrinter", "cgroups", "");
+
+    auto printer = std::make_unique<CgroupPrinter>(config, paths, watch_oom);
+    free_property_array(paths);
+
+    return printer;
+}
+} /* namespace swaystatus::modules */
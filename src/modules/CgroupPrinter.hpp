@@ -0,0 +1,10 @@
+#ifndef  __swaystatus_CgroupPrinter_HPP__
+# define __swaystatus_CgroupPrinter_HPP__
+
+# include "Base.hpp"
+
+namespace swaystatus::modules {
+std::unique_ptr<Base> makeCgroupPrinter(void *config);
+} /* namespace swaystatus::modules */
+
+#endif
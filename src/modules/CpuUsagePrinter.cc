@@ -0,0 +1,172 @@
+#include <err.h>
+#include <errno.h>
+
+#include <unistd.h> /* For pread */
+#include <fcntl.h>  /* For AT_FDCWD and O_RDONLY */
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../utility.h"
+#include "../Fd.hpp"
+#include "../proc_stat.hpp"
+#include "../sparkline.hpp"
+
+#include "CpuUsagePrinter.hpp"
+
+namespace swaystatus {
+/**
+ * Usage of every core rendered as one bar, e.g. "▁▁▃█"
+ */
+struct cpu_usage_bars {
+    const std::vector<std::uint8_t> &usages;
+};
+} /* namespace swaystatus */
+
+template <>
+struct fmt::formatter<swaystatus::cpu_usage_bars>
+{
+    using cpu_usage_bars = swaystatus::cpu_usage_bars;
+
+    using format_parse_context_it = typename format_parse_context::iterator;
+    using format_context_it = typename format_context::iterator;
+
+    auto parse(format_parse_context &ctx) -> format_parse_context_it
+    {
+        return ctx.begin();
+    }
+    auto format(const cpu_usage_bars &bars, format_context &ctx) -> format_context_it
+    {
+        auto out = ctx.out();
+        for (auto usage: bars.usages) {
+            const char *bar = swaystatus::get_bar(usage, 100);
+            for (; *bar != '\0'; ++bar) {
+                *out = *bar;
+                ++out;
+            }
+        }
+        return out;
+    }
+};
+
+using namespace std::literals;
+
+namespace swaystatus::modules {
+class CpuUsagePrinter: public Base {
+    static constexpr const char * const path = "/proc/stat";
+
+    Fd stat_fd;
+    /**
+     * It only grows when /proc/stat is larger than ever seen.
+     */
+    std::vector<char> buffer = std::vector<char>(4096);
+
+    proc_stat prev_stat;
+    proc_stat stat;
+    std::uint64_t prev_timestamp = 0;
+
+    std::uint8_t usage = 0;
+    std::uint8_t max_core_usage = 0;
+    std::vector<std::uint8_t> core_usages;
+
+    std::uint64_t ctxt_rate = 0;
+    std::uint64_t intr_rate = 0;
+
+    /**
+     * @return length of content read
+     */
+    std::size_t read_stat()
+    {
+        ssize_t len = aspreadall(stat_fd.get(), buffer);
+        if (len == -1)
+            err(1, "%s on %s failed", "pread", path);
+
+        return len;
+    }
+
+    static std::uint64_t get_rate(std::uint64_t prev, std::uint64_t curr, std::uint64_t elapsed)
+        noexcept
+    {
+        if (curr < prev || elapsed == 0)
+            return 0;
+        return (curr - prev) * 1000 * 1000 * 1000 / elapsed;
+    }
+
+    void update_usages(std::uint64_t elapsed)
+    {
+        usage = get_busy_percentage(prev_stat.total, stat.total);
+
+        const auto core_cnt = stat.cores.size();
+        core_usages.resize(core_cnt);
+        max_core_usage = 0;
+
+        for (std::size_t i = 0; i != core_cnt; ++i) {
+            // Cores might be offlined or onlined since the last update
+            if (i < prev_stat.cores.size() && prev_stat.core_ids[i] == stat.core_ids[i])
+                core_usages[i] = get_busy_percentage(prev_stat.cores[i], stat.cores[i]);
+            else
+                core_usages[i] = 0;
+
+            if (core_usages[i] > max_core_usage)
+                max_core_usage = core_usages[i];
+        }
+
+        ctxt_rate = get_rate(prev_stat.ctxt, stat.ctxt, elapsed);
+        intr_rate = get_rate(prev_stat.intr, stat.intr, elapsed);
+    }
+
+public:
+    CpuUsagePrinter(void *config):
+        Base{
+            config, "CpuUsagePrinter"sv,
+            2, "CPU {usage}% {per_core_bars}", "CPU {usage}%"
+        },
+        stat_fd{openat_checked("", AT_FDCWD, path, O_RDONLY)}
+    {}
+
+    void update()
+    {
+        using std::swap;
+
+        swap(prev_stat, stat);
+
+        auto len = read_stat();
+        if (!parse_proc_stat(buffer.data(), len, stat))
+            errx(1, "%s on %s failed", "Assumption", path);
+
+        const auto timestamp = get_monotonic_timestamp();
+        const auto elapsed = prev_timestamp == 0 ? 0 : timestamp - prev_timestamp;
+        prev_timestamp = timestamp;
+
+        if (elapsed != 0)
+            update_usages(elapsed);
+        else
+            core_usages.assign(stat.cores.size(), 0);
+    }
+    void do_print(const char *format)
+    {
+        print(
+            format,
+            fmt::arg("usage",          usage),
+            fmt::arg("max_core_usage", max_core_usage),
+            fmt::arg("core_count",     stat.cores.size()),
+            fmt::arg("per_core_bars",  cpu_usage_bars{core_usages}),
+            fmt::arg("ctxt_rate",      ctxt_rate),
+            fmt::arg("intr_rate",      intr_rate)
+        );
+    }
+    void reload()
+    {}
+
+    bool can_update_off_thread() const noexcept
+    {
+        return true;
+    }
+};
+
+std::unique_ptr<Base> makeCpuUsagePrinter(void *config)
+{
+    return std::make_unique<CpuUsagePrinter>(config);
+}
+} /* namespace swaystatus::modules */
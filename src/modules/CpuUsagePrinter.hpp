@@ -0,0 +1,10 @@
+#ifndef  __swaystatus_CpuUsagePrinter_HPP__
+# define __swaystatus_CpuUsagePrinter_HPP__
+
+# include "Base.hpp"
+
+namespace swaystatus::modules {
+std::unique_ptr<Base> makeCpuUsagePrinter(void *config);
+} /* namespace swaystatus::modules */
+
+#endif
@@ -1,5 +1,13 @@
+#include <err.h>
+
+#include <atomic>
+#include <string>
+
 #include "../process_configuration.h"
+#include "../TripleBuffer.hpp"
 #include "../Callback/Callable.hpp"
+#include "../Callback/async_thread.hpp"
+#include "../Callback/coroutine_runner.hpp"
 
 #include "CustomPrinter.hpp"
 
@@ -9,40 +17,217 @@ class CustomPrinter: public Base {
     swaystatus::Callable<void> update_callback;
     swaystatus::Callable<std::string> do_print_callback;
 
+    /**
+     * If set, callbacks are called by submit_async() and the result of do_print_callback
+     * is handed off through mailbox.
+     */
+    const bool is_async;
+    /**
+     * If set, do_print_callback writes into a memoryview over the print buffer instead of
+     * returning a str.
+     */
+    const bool write_to_buffer;
+
+    /**
+     * Single-slot mailbox holding the latest result of do_print_callback, written by the
+     * async thread and read by the main thread.
+     */
+    TripleBuffer<std::string> mailbox;
+    /**
+     * Set by the main thread on submitting and cleared by the async thread once the result
+     * is published.
+     */
+    std::atomic<bool> is_busy{false};
+
+#ifdef USE_PYTHON
+    /**
+     * Drives update_callback defined with `async def`.
+     */
+    python::CoroutineRunner runner{on_coroutine_done, this};
+
+    static void on_coroutine_done(void *data)
+    {
+        // Print the result now, which also starts the coroutine again.
+        static_cast<CustomPrinter*>(data)->request_immediate_update();
+    }
+
+    /**
+     * Size of the memoryview passed to do_print_callback, grown once it asks for more.
+     */
+    std::size_t write_capacity = 256;
+
+    /**
+     * Let do_print_callback write into the print buffer of the calling thread.
+     */
+    void print_by_writing()
+    {
+        do_print_callback.with_python_callable([this](python::Callable_base &callable)
+        {
+            for (;;) {
+                auto *buffer = reserve_print_buffer(write_capacity);
+
+                python::MemoryView view{buffer, write_capacity};
+                python::Int ret{callable(view)};
+                // The buffer might be moved once anything is printed.
+                view.release();
+
+                std::size_t len;
+                if (!ret.to_size_t(&len))
+                    errx(1, "%s on %s.%s%s", "Invalid return value", "custom", "do_print_callback",
+                            ": Expected number of bytes written");
+
+                if (len <= write_capacity) {
+                    commit_print_buffer(len);
+                    return;
+                }
+
+                // Try again with a buffer as large as it asks for.
+                commit_print_buffer(0);
+                write_capacity = len;
+            }
+        });
+    }
+#endif
+
+    static void update_async(void *data)
+    {
+        auto *self = static_cast<CustomPrinter*>(data);
+
+        self->update_callback();
+
+        auto &result = self->mailbox.get_back();
+#ifdef USE_PYTHON
+        if (self->write_to_buffer) {
+            result.clear();
+            self->print_by_writing();
+            take_buffer(result);
+        } else
+#endif
+            result = self->do_print_callback();
+        self->mailbox.publish();
+
+        self->is_busy.store(false, std::memory_order_release);
+    }
+
 public:
     CustomPrinter(
         void *config,
         Callable_base &&update_callback_base,
-        Callable_base &&do_print_callback_base
+        Callable_base &&do_print_callback_base,
+        bool is_async,
+        bool write_to_buffer
     ):
-        Base{config, "custom", 1, "", nullptr, "click_event_handler", "update_callback", "do_print_callback"},
+        Base{
+            config, "custom", 1, "", nullptr,
+            "click_event_handler", "update_callback", "do_print_callback", "async",
+            "subinterpreter", "write_to_buffer"
+        },
         update_callback{std::move(update_callback_base)},
-        do_print_callback{std::move(do_print_callback_base)}
-    {}
+        do_print_callback{std::move(do_print_callback_base)},
+        is_async{is_async},
+        write_to_buffer{write_to_buffer}
+    {
+#ifdef USE_PYTHON
+        if (write_to_buffer && !do_print_callback.get_python_callable())
+#else
+        if (write_to_buffer)
+#endif
+            errx(1, "%s on %s.%s%s", "Not supported", "custom", "write_to_buffer",
+                    ": do_print_callback is not written in python");
+
+#ifdef USE_PYTHON
+        // Coroutines can only be driven by the poller on the main thread.
+        if ((is_async || is_blocking()) && update_callback.get_python_callable()) {
+            bool is_coroutine = update_callback.with_python_callable(
+                [](python::Callable_base &callable) { return callable.is_coroutine_function(); }
+            );
+            if (is_coroutine)
+                errx(1, "%s on %s.%s%s", "Not supported", "custom", "update_callback",
+                        ": async def is not supported with \"async\" or \"blocking\"");
+        }
+#endif
+    }
 
     ~CustomPrinter() = default;
 
     void update()
     {
-        update_callback();
+        if (!is_async) {
+#ifdef USE_PYTHON
+            // Coroutines can only be driven on the main thread.
+            auto *callable = update_callback.get_python_callable();
+            if (callable && !is_blocking()) {
+                // The coroutine started before is still waiting.
+                if (runner.is_running())
+                    return;
+
+                auto &interpreter = *update_callback.get_python_interpreter();
+                auto scope = interpreter.acquire();
+                runner.start((*callable)(), interpreter);
+                return;
+            }
+#endif
+            update_callback();
+            return;
+        }
+
+        // Updates requested while the last one is still running are dropped.
+        if (!is_busy.load(std::memory_order_acquire)) {
+            is_busy.store(true, std::memory_order_relaxed);
+            submit_async(update_async, this);
+        }
     }
     void do_print(const char *format)
     {
         (void) format;
 
-        print_str2(do_print_callback());
+        if (!is_async) {
+#ifdef USE_PYTHON
+            if (write_to_buffer) {
+                print_by_writing();
+                return;
+            }
+            if (do_print_callback.get_python_callable()) {
+                // Print straight from the utf-8 cached in the str without copying it.
+                do_print_callback.with_python_callable([](python::Callable_base &callable)
+                {
+                    print_str2(python::str{callable()}.get_view());
+                });
+                return;
+            }
+#endif
+            print_str2(do_print_callback());
+            return;
+        }
+
+        // The last result is printed until a new one arrives.
+        mailbox.update_front();
+        print_str2(mailbox.get_front());
     }
     void reload()
     {
         ;
     }
+
+    bool can_update_off_thread() const noexcept
+    {
+        // Async callbacks already run on their own thread.
+        return !is_async;
+    }
 };
 
 std::unique_ptr<Base> makeCustomPrinter(void *config) {
+    auto is_async = get_bool_property(config, "custom", "async", false);
+    auto write_to_buffer = get_bool_property(config, "custom", "write_to_buffer", false);
+    // Shared by both callbacks, so that they see the same module.
+    CallableInterpreter interpreter{get_bool_property(config, "custom", "subinterpreter", false)};
+
     return std::make_unique<CustomPrinter>(
         config,
-        Callable_base("custom_block", get_callable(config, "update_callback")),
-        Callable_base("custom_block", get_callable(config, "do_print_callback"))
+        Callable_base("custom_block", get_callable(config, "update_callback"), &interpreter),
+        Callable_base("custom_block", get_callable(config, "do_print_callback"), &interpreter),
+        is_async,
+        write_to_buffer
     );
 }
 } /* namespace swaystatus::modules */
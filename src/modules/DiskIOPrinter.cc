@@ -0,0 +1,73 @@
+#include <err.h>
+
+#include <utility>
+
+#include "../process_configuration.h"
+#include "../mem_size_t.hpp"
+#include "../diskstats.hpp"
+
+#include "DiskIOPrinter.hpp"
+
+using namespace std::literals;
+
+namespace swaystatus::modules {
+class DiskIOPrinter: public Base {
+    Disks disks;
+
+public:
+    DiskIOPrinter(void *config, NameFilter &&filter, std::size_t rate_window):
+        Base{
+            config, "DiskIOPrinter"sv,
+            2,
+            "{per_disk_fmt_str:{name} R {read_rate}/s W {write_rate}/s}",
+            "R {read_rate}/s W {write_rate}/s",
+            "rate_window", "include", "exclude"
+        },
+        disks{std::move(filter), rate_window}
+    {}
+
+    void update()
+    {
+        disks.update();
+    }
+    void do_print(const char *format)
+    {
+        const auto &rates = disks.get_total_rates();
+
+        print(
+            format,
+            fmt::arg("disk_count", disks.size()),
+
+            fmt::arg("read_rate",  mem_size_t{rates.read_bytes}),
+            fmt::arg("write_rate", mem_size_t{rates.write_bytes}),
+            fmt::arg("read_iops",  rates.read_iops),
+            fmt::arg("write_iops", rates.write_iops),
+            fmt::arg("max_util",   rates.util),
+
+            fmt::arg("per_disk_fmt_str", disks)
+        );
+    }
+    void reload()
+    {}
+
+    bool can_update_off_thread() const noexcept
+    {
+        return true;
+    }
+};
+
+std::unique_ptr<Base> makeDiskIOPrinter(void *config)
+{
+    auto rate_window = get_uint_property(config, "DiskIOPrinter", "rate_window", 10);
+    if (rate_window == 0)
+        errx(1, "%s on %s.%s%s", "Zero is not accepted", "DiskIOPrinter", "rate_window", "");
+
+    auto filter = NameFilter::from_config(config, "DiskIOPrinter", "include", "exclude");
+    if (filter.is_empty()) {
+        static const char * const default_excludes[] = {"loop*", "ram*", nullptr};
+        filter = NameFilter{nullptr, default_excludes};
+    }
+
+    return std::make_unique<DiskIOPrinter>(config, std::move(filter), rate_window);
+}
+} /* namespace swaystatus::modules */
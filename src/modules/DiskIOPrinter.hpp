@@ -0,0 +1,10 @@
+#ifndef  __swaystatus_DiskIOPrinter_HPP__
+# define __swaystatus_DiskIOPrinter_HPP__
+
+# include "Base.hpp"
+
+namespace swaystatus::modules {
+std::unique_ptr<Base> makeDiskIOPrinter(void *config);
+} /* namespace swaystatus::modules */
+
+#endif
@@ -0,0 +1,81 @@
+#include <err.h>
+
+#include "../process_configuration.h"
+#include "../poller.h"
+#include "../mounts.hpp"
+
+#include "DiskUsagePrinter.hpp"
+
+using namespace std::literals;
+
+namespace swaystatus::modules {
+class DiskUsagePrinter: public Base {
+    MountPoints mount_points;
+    std::uint8_t urgent_percent;
+
+    static void on_mount_table_change(int, enum Event events, void *data)
+    {
+        auto *self = static_cast<DiskUsagePrinter*>(data);
+
+        // /proc/self/mountinfo reports POLLERR along with POLLPRI when mount table changes.
+        if (events & (pri_ready | error)) {
+            self->mount_points.handle_notification();
+            self->request_update();
+        }
+    }
+
+public:
+    DiskUsagePrinter(void *config, const char * const *paths, std::uint8_t urgent_percent):
+        Base{
+            config, "DiskUsagePrinter"sv,
+            60,
+            "{per_mount_point_fmt_str:{mount_point} {free} free}",
+            "{per_mount_point_fmt_str:{mount_point} {percent}%}",
+            "mount_points", "urgent_percent"
+        },
+        mount_points{paths},
+        urgent_percent{urgent_percent}
+    {
+        request_polling(mount_points.get_mountinfo_fd(), pri_ready, on_mount_table_change, this);
+    }
+
+    void update()
+    {
+        mount_points.update();
+        set_urgent(urgent_percent != 0 && mount_points.get_max_percent() >= urgent_percent);
+    }
+    void do_print(const char *format)
+    {
+        print(
+            format,
+            fmt::arg("mount_point_count", mount_points.size()),
+            fmt::arg("max_percent",       mount_points.get_max_percent()),
+
+            fmt::arg("per_mount_point_fmt_str", mount_points)
+        );
+    }
+    void reload()
+    {
+        mount_points.handle_notification();
+    }
+};
+
+std::unique_ptr<Base> makeDiskUsagePrinter(void *config)
+{
+    auto urgent_percent = get_uint_property(config, "DiskUsagePrinter", "urgent_percent", 90);
+    if (urgent_percent > 100)
+        errx(1, "%s on %s.%s%s", "Value out of range [0, 100]",
+                "DiskUsagePrinter", "urgent_percent", "");
+
+    static const char * const default_paths[] = {"/", nullptr};
+
+    auto *paths = get_property_array(config, "DiskUsagePrinter", "mount_points");
+
+    auto printer = std::make_unique<DiskUsagePrinter>(
+        config, paths ? paths : default_paths, static_cast<std::uint8_t>(urgent_percent)
+    );
+    free_property_array(paths);
+
+    return printer;
+}
+} /* namespace swaystatus::modules */
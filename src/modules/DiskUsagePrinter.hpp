@@ -0,0 +1,10 @@
+#ifndef  __swaystatus_DiskUsagePrinter_HPP__
+# define __swaystatus_DiskUsagePrinter_HPP__
+
+# include "Base.hpp"
+
+namespace swaystatus::modules {
+std::unique_ptr<Base> makeDiskUsagePrinter(void *config);
+} /* namespace swaystatus::modules */
+
+#endif
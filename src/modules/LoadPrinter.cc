@@ -93,6 +93,11 @@ public:
     }
     void reload()
     {}
+
+    bool can_update_off_thread() const noexcept
+    {
+        return true;
+    }
 };
 
 std::unique_ptr<Base> makeLoadPrinter(void *config)
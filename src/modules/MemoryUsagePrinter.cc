@@ -14,6 +14,7 @@
 #include "../formatting/printer.hpp"
 #include "../formatting/LazyEval.hpp"
 #include "../mem_size_t.hpp"
+#include "../native_views.hpp"
 #include "MemoryUsagePrinter.hpp"
 
 using namespace std::literals;
@@ -26,6 +27,8 @@ class MemoryUsagePrinter: public Base {
     std::size_t memtotal = -1;
     std::string buffer;
 
+    NativeView &view = *get_native_view("meminfo"sv);
+
     void read_meminfo()
     {
         ssize_t cnt = asreadall(meminfo_fd.get(), buffer);
@@ -91,6 +94,11 @@ public:
         read_meminfo();
         if (UNLIKELY(memtotal == static_cast<std::size_t>(-1) ))
             memtotal = get_memusage("MemTotal"sv);
+
+        view.publish([&](NativeSnapshot &snapshot)
+        {
+            snapshot.data.assign(buffer);
+        });
     }
     void do_print(const char *format)
     {
@@ -116,6 +124,11 @@ public:
     }
     void reload()
     {}
+
+    bool can_update_off_thread() const noexcept
+    {
+        return true;
+    }
 };
 
 std::unique_ptr<Base> makeMemoryUsagePrinter(void *config)
@@ -1,5 +1,13 @@
+#include <err.h>
+
+#include <string>
+#include <utility>
+
+#include "../process_configuration.h"
+#include "../poller.h"
 #include "../formatting/Conditional.hpp"
 #include "../networking.hpp"
+#include "../native_views.hpp"
 
 #include "NetworkInterfacesPrinter.hpp"
 
@@ -9,8 +17,38 @@ namespace swaystatus::modules {
 class NetworkInterfacesPrinter: public Base {
     Interfaces interfaces;
 
+    NativeView &view = *get_native_view("network"sv);
+
+    /**
+     * Format of interface_stats_record in the syntax of python module struct
+     */
+    static auto get_record_format() -> const char*
+    {
+        static_assert(sizeof(interface_stats) % sizeof(__u32) == 0);
+        static_assert(sizeof(interface_stats_record) == IFNAMSIZ + sizeof(interface_stats));
+
+        static const std::string format = fmt::format(
+            "{}s{}I", IFNAMSIZ, sizeof(interface_stats) / sizeof(__u32)
+        );
+        return format.c_str();
+    }
+
+    static void on_route_change(int fd, enum Event events, void *data)
+    {
+        (void) fd;
+        (void) events;
+
+        auto *self = static_cast<NetworkInterfacesPrinter*>(data);
+        if (self->interfaces.get_routes().handle_notifications())
+            self->request_update();
+    }
+
 public:
-    NetworkInterfacesPrinter(void *config):
+    NetworkInterfacesPrinter(
+        void *config,
+        std::size_t rate_window, std::size_t max_interfaces,
+        interfaces_filter &&filter
+    ):
         Base{
             config, "NetworkInterfacesPrinter"sv,
             60 * 2,
@@ -20,13 +58,35 @@ public:
             "}}",
             "{is_connected:{per_interface_fmt_str:"
                 "{name}"
-            "}}"
-        }
-    {}
+            "}}",
+            "rate_window", "max_interfaces", "include", "exclude", "address_scopes",
+            "primary_only"
+        },
+        interfaces{rate_window, max_interfaces, std::move(filter)}
+    {
+        request_polling(
+            interfaces.get_routes().get_notification_fd(), read_ready, on_route_change, this
+        );
+    }
 
     void update()
     {
         interfaces.update();
+
+        view.publish([&](NativeSnapshot &snapshot)
+        {
+            snapshot.format = get_record_format();
+            snapshot.itemsize = sizeof(interface_stats_record);
+
+            snapshot.data.clear();
+            for (const auto &interface: interfaces) {
+                interface_stats_record record = {};
+                interface.name.copy(record.name, sizeof(record.name) - 1);
+                record.stat = interface.stat;
+
+                snapshot.data.append(reinterpret_cast<const char*>(&record), sizeof(record));
+            }
+        });
     }
     void do_print(const char *format)
     {
@@ -49,6 +109,37 @@ public:
 
 std::unique_ptr<Base> makeNetworkInterfacesPrinter(void *config)
 {
-    return std::make_unique<NetworkInterfacesPrinter>(config);
+    auto rate_window = get_uint_property(config, "NetworkInterfacesPrinter", "rate_window", 10);
+    if (rate_window == 0)
+        errx(1, "%s on %s.%s%s", "Zero is not accepted", "NetworkInterfacesPrinter", "rate_window", "");
+
+    auto max_interfaces = get_uint_property(
+        config, "NetworkInterfacesPrinter", "max_interfaces", UINT32_MAX
+    );
+
+    interfaces_filter filter{
+        NameFilter::from_config(config, "NetworkInterfacesPrinter", "include", "exclude")
+    };
+
+    filter.primary_only = get_bool_property(
+        config, "NetworkInterfacesPrinter", "primary_only", false
+    );
+
+    auto *scopes = get_property_array(config, "NetworkInterfacesPrinter", "address_scopes");
+    if (scopes) {
+        filter.addr_scopes = 0;
+        for (auto it = scopes; *it; ++it) {
+            auto scope = parse_addr_scope(*it);
+            if (scope == 0)
+                errx(1, "%s on %s.%s%s",
+                        "Invalid value", "NetworkInterfacesPrinter", "address_scopes", "");
+            filter.addr_scopes |= scope;
+        }
+        free_property_array(scopes);
+    }
+
+    return std::make_unique<NetworkInterfacesPrinter>(
+        config, rate_window, max_interfaces, std::move(filter)
+    );
 }
 } /* namespace swaystatus::modules */
@@ -0,0 +1,172 @@
+#include <err.h>
+
+#include <list>
+
+#include "../utility.h"
+#include "../poller.h"
+#include "../process_configuration.h"
+#include "../plugin.h"
+#include "../formatting/printer.hpp"
+#include "../Callback/dynlib.hpp"
+
+#include "PluginPrinter.hpp"
+
+using namespace std::literals;
+
+static_assert(static_cast<int>(swaystatus_read_ready) == read_ready);
+static_assert(static_cast<int>(swaystatus_pri_ready) == pri_ready);
+static_assert(static_cast<int>(swaystatus_error) == error);
+static_assert(static_cast<int>(swaystatus_hup) == hup);
+static_assert(static_cast<int>(swaystatus_invalid_fd) == invalid_fd);
+
+namespace swaystatus::modules {
+class PluginPrinter: public Base {
+    const struct swaystatus_plugin &plugin;
+    void *state;
+
+    static void print_str2(const char *str, std::size_t len)
+    {
+        swaystatus::print_str2(str, len);
+    }
+    static auto reserve_print_buffer(std::size_t n) -> char*
+    {
+        return swaystatus::reserve_print_buffer(n);
+    }
+    static void commit_print_buffer(std::size_t len)
+    {
+        swaystatus::commit_print_buffer(len);
+    }
+    struct polled_fd {
+        int fd;
+        swaystatus_poller_callback callback;
+        void *data;
+    };
+    /**
+     * Callbacks of plugins have a different signature from poller_callback, so they are
+     * called through on_poll_event with a pointer to its entry here, which is stable since
+     * it is a list.
+     */
+    static inline std::list<polled_fd> polled_fds;
+
+    static void on_poll_event(int fd, enum Event events, void *data)
+    {
+        const auto &entry = *static_cast<const polled_fd*>(data);
+        // Copied since entry is erased if the callback cancels polling fd.
+        auto callback = entry.callback;
+        auto *callback_data = entry.data;
+
+        // enum swaystatus_event has the same values as enum Event.
+        callback(fd, static_cast<swaystatus_event>(events), callback_data);
+    }
+
+    static void request_polling(
+        int fd, enum swaystatus_event events, swaystatus_poller_callback callback, void *data
+    )
+    {
+        auto &entry = polled_fds.emplace_back(polled_fd{fd, callback, data});
+        ::request_polling(fd, static_cast<Event>(events), on_poll_event, &entry);
+    }
+    static void cancel_polling(int fd)
+    {
+        ::cancel_polling(fd);
+
+        // Same as the poller, only the first entry of fd is removed.
+        for (auto it = polled_fds.begin(); it != polled_fds.end(); ++it) {
+            if (it->fd == fd) {
+                polled_fds.erase(it);
+                break;
+            }
+        }
+    }
+
+    static void request_update(void *module)
+    {
+        static_cast<PluginPrinter*>(module)->Base::request_update();
+    }
+    static void request_immediate_update(void *module)
+    {
+        static_cast<PluginPrinter*>(module)->Base::request_immediate_update();
+    }
+    static void set_urgent(void *module, int urgent)
+    {
+        static_cast<PluginPrinter*>(module)->Base::set_urgent(urgent != 0);
+    }
+
+    static constexpr const swaystatus_plugin_host host = {
+        .abi_version = SWAYSTATUS_PLUGIN_ABI_VERSION,
+
+        .print_str2 = print_str2,
+        .reserve_print_buffer = reserve_print_buffer,
+        .commit_print_buffer = commit_print_buffer,
+
+        .request_polling = request_polling,
+        .cancel_polling = cancel_polling,
+        .create_timer = create_pollable_monotonic_timer,
+        .read_timer = read_timer,
+
+        .request_update = request_update,
+        .request_immediate_update = request_immediate_update,
+        .set_urgent = set_urgent,
+    };
+
+public:
+    PluginPrinter(void *config, const char *path, const struct swaystatus_plugin &plugin,
+                  const char *plugin_config):
+        Base{
+            config, "plugin"sv,
+            1, "", nullptr,
+            "path", "config"
+        },
+        plugin{plugin},
+        state{plugin.init(&host, this, plugin_config)}
+    {
+        if (state == nullptr)
+            errx(1, "%s on %s.%s: %s", "Failed to initialize", "plugin", "path", path);
+    }
+
+    ~PluginPrinter()
+    {
+        if (plugin.fini)
+            plugin.fini(state);
+    }
+
+    void update()
+    {
+        plugin.update(state);
+    }
+    void do_print(const char *format)
+    {
+        plugin.render(state, format);
+    }
+    void reload()
+    {
+        if (plugin.reload)
+            plugin.reload(state);
+    }
+
+    bool can_update_off_thread() const noexcept
+    {
+        return plugin.flags & SWAYSTATUS_PLUGIN_UPDATE_OFF_THREAD;
+    }
+};
+
+std::unique_ptr<Base> makePluginPrinter(void *config)
+{
+    std::unique_ptr<const char[]> path{get_property(config, "path", nullptr)};
+    if (!path)
+        errx(1, "%s on %s.%s%s", "Missing property", "plugin", "path", "");
+
+    auto &plugin = *static_cast<const struct swaystatus_plugin*>(
+        dload_symbol(path.get(), "swaystatus_plugin")
+    );
+    if (plugin.abi_version != SWAYSTATUS_PLUGIN_ABI_VERSION)
+        errx(1, "%s on %s.%s: %s", "Incompatible ABI version", "plugin", "path", path.get());
+    // reload and fini are optional
+    if (!plugin.init || !plugin.update || !plugin.render)
+        errx(1, "%s on %s.%s: %s", "Missing init, update or render", "plugin", "path", path.get());
+
+    std::unique_ptr<const char[]> plugin_config{get_property(config, "config", nullptr)};
+
+    return std::make_unique<PluginPrinter>(config, path.get(), plugin, plugin_config.get());
+}
+} /* namespace swaystatus::modules */
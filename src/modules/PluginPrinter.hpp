@@ -0,0 +1,10 @@
+#ifndef  __swaystatus_PluginPrinter_HPP__
+# define __swaystatus_PluginPrinter_HPP__
+
+# include "Base.hpp"
+
+namespace swaystatus::modules {
+std::unique_ptr<Base> makePluginPrinter(void *config);
+} /* namespace swaystatus::modules */
+
+#endif
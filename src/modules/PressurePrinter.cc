@@ -0,0 +1,169 @@
+#define _POSIX_C_SOURCE 200809L /* For AT_FDCWD */
+
+#include <err.h>
+#include <errno.h>
+
+#include <unistd.h> /* For write */
+#include <fcntl.h>  /* For AT_FDCWD and O_RDONLY */
+
+#include <cstdio>
+#include <cstdint>
+#include <cinttypes>
+#include <cstring>
+
+#include "../utility.h"
+#include "../Fd.hpp"
+#include "../poller.h"
+#include "../process_configuration.h"
+#include "../formatting/Conditional.hpp"
+#include "../psi.hpp"
+
+#include "PressurePrinter.hpp"
+
+using namespace std::literals;
+
+namespace swaystatus::modules {
+class PressurePrinter: public Base {
+    struct resource {
+        const char *path;
+
+        Fd fd;
+        /**
+         * Fd with a trigger registered, it becomes POLLPRI when the threshold is exceeded.
+         */
+        Fd trigger_fd;
+
+        psi_stats stats;
+    };
+
+    resource resources[3] = {
+        {"/proc/pressure/cpu",    {}, {}, {}},
+        {"/proc/pressure/memory", {}, {}, {}},
+        {"/proc/pressure/io",     {}, {}, {}},
+    };
+
+    bool is_triggered = false;
+    /**
+     * Value of is_triggered at the last update, used by do_print.
+     */
+    bool was_triggered = false;
+
+    static void on_trigger(int, enum Event events, void *data)
+    {
+        auto *self = static_cast<PressurePrinter*>(data);
+
+        if (events & error)
+            errx(1, "%s on %s failed", "PSI trigger", "PressurePrinter");
+
+        if (events & pri_ready) {
+            self->is_triggered = true;
+            self->request_immediate_update();
+        }
+    }
+
+    /**
+     * Unprivileged users cannot create PSI triggers before linux 6.4, in which case
+     * no trigger is registered and the block is only updated every update_interval.
+     */
+    void register_triggers(std::uint32_t trigger_stall_us, std::uint32_t trigger_window_us)
+    {
+        char trigger[64];
+        std::snprintf(trigger, sizeof(trigger), "some %" PRIu32 " %" PRIu32,
+                      trigger_stall_us, trigger_window_us);
+
+        for (auto &res: resources) {
+            int fd = openat(AT_FDCWD, res.path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+            if (fd != -1)
+                res.trigger_fd = fd;
+
+            if (fd == -1 || write(fd, trigger, std::strlen(trigger) + 1) < 0) {
+                if (errno != EPERM && errno != EACCES)
+                    err(1, "%s on %s failed", "Registering PSI trigger", res.path);
+
+                warn("%s on %s failed, %s", "Registering PSI trigger", res.path,
+                     "falling back to update_interval");
+                for (auto &r: resources)
+                    r.trigger_fd = Fd{};
+                return;
+            }
+        }
+
+        for (auto &res: resources)
+            request_polling(res.trigger_fd.get(), pri_ready, on_trigger, this);
+    }
+
+public:
+    /**
+     * @param trigger_stall_us 0 to disable triggers
+     */
+    PressurePrinter(void *config, std::uint32_t trigger_stall_us, std::uint32_t trigger_window_us):
+        Base{
+            config, "PressurePrinter"sv,
+            5,
+            "CPU {cpu_some_avg10}% MEM {memory_some_avg10}% IO {io_some_avg10}%",
+            nullptr,
+            "triggers", "trigger_stall_ms", "trigger_window_ms"
+        }
+    {
+        for (auto &res: resources)
+            res.fd = openat_checked("", AT_FDCWD, res.path, O_RDONLY);
+
+        if (trigger_stall_us != 0)
+            register_triggers(trigger_stall_us, trigger_window_us);
+    }
+
+    void update()
+    {
+        for (auto &res: resources)
+            read_psi(res.fd.get(), res.path, res.stats);
+
+        // Stay urgent until an update passes without any trigger fired
+        set_urgent(is_triggered);
+        was_triggered = is_triggered;
+        is_triggered = false;
+    }
+    void do_print(const char *format)
+    {
+        auto &cpu = resources[0], &memory = resources[1], &io = resources[2];
+
+        print(
+            format,
+            fmt::arg("is_triggered", Conditional{was_triggered}),
+
+#define FMT_PSI_LINE(res, line)                                 \
+            fmt::arg(#res "_" #line "_avg10",  res.stats.line.avg10), \
+            fmt::arg(#res "_" #line "_avg60",  res.stats.line.avg60), \
+            fmt::arg(#res "_" #line "_avg300", res.stats.line.avg300),\
+            fmt::arg(#res "_" #line "_total",  res.stats.line.total)
+            FMT_PSI_LINE(cpu, some),
+            FMT_PSI_LINE(cpu, full),
+            FMT_PSI_LINE(memory, some),
+            FMT_PSI_LINE(memory, full),
+            FMT_PSI_LINE(io, some),
+            FMT_PSI_LINE(io, full)
+#undef  FMT_PSI_LINE
+        );
+    }
+    void reload()
+    {}
+};
+
+std::unique_ptr<Base> makePressurePrinter(void *config)
+{
+    auto triggers = get_bool_property(config, "PressurePrinter", "triggers", true);
+    auto stall_ms = get_uint_property(config, "PressurePrinter", "trigger_stall_ms", 150);
+    auto window_ms = get_uint_property(config, "PressurePrinter", "trigger_window_ms", 2000);
+
+    if (window_ms < 500 || window_ms > 10 * 1000)
+        errx(1, "%s on %s.%s%s", "Value out of range [500, 10000]",
+                "PressurePrinter", "trigger_window_ms", "");
+    if (stall_ms == 0 || stall_ms > window_ms)
+        errx(1, "%s on %s.%s%s", "Value out of range [1, trigger_window_ms]",
+                "PressurePrinter", "trigger_stall_ms", "");
+
+    if (!triggers)
+        stall_ms = 0;
+
+    return std::make_unique<PressurePrinter>(config, stall_ms * 1000, window_ms * 1000);
+}
+} /* namespace swaystatus::modules */
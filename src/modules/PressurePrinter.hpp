@@ -0,0 +1,10 @@
+#ifndef  __swaystatus_PressurePrinter_HPP__
+# define __swaystatus_PressurePrinter_HPP__
+
+# include "Base.hpp"
+
+namespace swaystatus::modules {
+std::unique_ptr<Base> makePressurePrinter(void *config);
+} /* namespace swaystatus::modules */
+
+#endif
@@ -0,0 +1,68 @@
+#include <err.h>
+
+#include <cstring>
+#include <memory>
+
+#include "../process_configuration.h"
+#include "../process_table.hpp"
+
+#include "ProcessesPrinter.hpp"
+
+using namespace std::literals;
+
+namespace swaystatus::modules {
+class ProcessesPrinter: public Base {
+    ProcessTable table;
+
+public:
+    ProcessesPrinter(void *config, std::size_t top_n, process_sort_key sort_key):
+        Base{
+            config, "ProcessesPrinter"sv,
+            5,
+            "{per_process_fmt_str:{comm} {cpu_usage}%}",
+            nullptr,
+            "top_n", "sort_by"
+        },
+        table{top_n, sort_key}
+    {}
+
+    void update()
+    {
+        table.update();
+    }
+    void do_print(const char *format)
+    {
+        print(
+            format,
+            fmt::arg("process_count",       table.get_process_count()),
+            fmt::arg("per_process_fmt_str", table.get_top())
+        );
+    }
+    void reload()
+    {}
+
+    bool can_update_off_thread() const noexcept
+    {
+        return true;
+    }
+};
+
+std::unique_ptr<Base> makeProcessesPrinter(void *config)
+{
+    auto top_n = get_uint_property(config, "ProcessesPrinter", "top_n", 3);
+    if (top_n == 0)
+        errx(1, "%s on %s.%s%s", "Zero is not accepted", "ProcessesPrinter", "top_n", "");
+
+    std::unique_ptr<const char[]> sort_by{get_property(config, "sort_by", "cpu")};
+
+    process_sort_key sort_key;
+    if (std::strcmp(sort_by.get(), "cpu") == 0)
+        sort_key = process_sort_key::cpu;
+    else if (std::strcmp(sort_by.get(), "memory") == 0)
+        sort_key = process_sort_key::memory;
+    else
+        errx(1, "%s on %s.%s%s", "Invalid value", "ProcessesPrinter", "sort_by", "");
+
+    return std::make_unique<ProcessesPrinter>(config, top_n, sort_key);
+}
+} /* namespace swaystatus::modules */
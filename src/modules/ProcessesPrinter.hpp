@@ -0,0 +1,10 @@
+#ifndef  __swaystatus_ProcessesPrinter_HPP__
+# define __swaystatus_ProcessesPrinter_HPP__
+
+# include "Base.hpp"
+
+namespace swaystatus::modules {
+std::unique_ptr<Base> makeProcessesPrinter(void *config);
+} /* namespace swaystatus::modules */
+
+#endif
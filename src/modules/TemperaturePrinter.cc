@@ -1,3 +1,9 @@
+#include <err.h>
+
+#include <utility>
+
+#include "../process_configuration.h"
+#include "../formatting/Conditional.hpp"
 #include "../sensors.hpp"
 
 #include "TemperaturePrinter.hpp"
@@ -7,54 +13,93 @@ using namespace std::literals;
 namespace swaystatus::modules {
 class TemperaturePrinter: public Base {
     Sensors sensors;
-    typename Sensors::const_iterator reading_it;
 
 public:
-    TemperaturePrinter(void *config):
+    TemperaturePrinter(void *config, bool use_libsensors, sensors_filter &&filter):
         Base{
             config, "TemperaturePrinter"sv,
-            5, "{prefix} {reading_number}th sensor: {reading_temp}°C", nullptr
+            5, "{has_reading:{hottest_label} {max_temp}°C}", nullptr,
+            "use_libsensors", "reading_types",
+            "include_chips", "exclude_chips", "include_labels", "exclude_labels"
         },
-        /**
-         * Here, reading_it = sensors.begin() = sensor.end()
-         */
-        reading_it{sensors.begin()}
+        sensors{use_libsensors, std::move(filter)}
     {}
 
     void update()
     {
-        ++reading_it;
-        if (reading_it >= sensors.end()) {
-            sensors.update();
-            reading_it = sensors.begin();
-        }
+        sensors.update();
+        set_urgent(sensors.get_alarm_count() != 0);
     }
     void do_print(const char *format)
     {
-        auto &sensor = *reading_it->sensor;
-        auto &bus = sensor.bus;
-        auto &reading = *reading_it;
+        const auto *hottest = sensors.get_hottest();
+        const Sensor *hottest_sensor = hottest ? &sensors.get_sensor(*hottest) : nullptr;
+        const sensor_bus_id no_bus = {sensor_bus_type{-1}, -1};
+        const sensor_bus_id &hottest_bus = hottest_sensor ? hottest_sensor->bus : no_bus;
 
         print(
             format,
-            fmt::arg("prefix",   sensor.prefix),
-            fmt::arg("path",     sensor.path),
-            fmt::arg("addr",     sensor.addr),
-            fmt::arg("bus_type", bus.type),
-            fmt::arg("bus_nr",   bus.nr),
-
-            fmt::arg("reading_number", reading.number),
-            fmt::arg("reading_temp",   reading.temp)
+            fmt::arg("has_reading",    Conditional{hottest != nullptr}),
+            fmt::arg("has_no_reading", Conditional{hottest == nullptr}),
+            fmt::arg("has_alarm",      Conditional{sensors.get_alarm_count() != 0}),
+            fmt::arg("alarm_count",    sensors.get_alarm_count()),
+
+            fmt::arg("max_temp", sensors.get_max_temp()),
+            fmt::arg("avg_temp", sensors.get_avg_temp()),
+
+            fmt::arg("hottest_prefix", hottest_sensor ? hottest_sensor->prefix : ""sv),
+            fmt::arg("hottest_path",   hottest_sensor ? hottest_sensor->path : ""sv),
+            fmt::arg("hottest_label",  hottest ? hottest->label : ""sv),
+
+            fmt::arg("per_sensor_fmt_str", sensors),
+
+            // Variables of the reading shown before readings were aggregated, kept for
+            // compatibility with existing formats. They now refer to the hottest reading.
+            fmt::arg("prefix",         hottest_sensor ? hottest_sensor->prefix : ""sv),
+            fmt::arg("path",           hottest_sensor ? hottest_sensor->path : ""sv),
+            fmt::arg("addr",           hottest_sensor ? hottest_sensor->addr : -1),
+            fmt::arg("bus_type",       hottest_bus.type),
+            fmt::arg("bus_nr",         hottest_bus.nr),
+            fmt::arg("reading_number", hottest ? hottest->number : 0),
+            fmt::arg("reading_temp",   sensors.get_max_temp())
         );
     }
     void reload()
     {
         sensors.reload();
     }
+
+    bool can_update_off_thread() const noexcept
+    {
+        return true;
+    }
 };
 
 std::unique_ptr<Base> makeTemperaturePrinter(void *config)
 {
-    return std::make_unique<TemperaturePrinter>(config);
+    auto use_libsensors = get_bool_property(config, "TemperaturePrinter", "use_libsensors", false);
+    if (use_libsensors && !load_libsensors()) {
+        warnx("%s is disabled", "TemperaturePrinter");
+        return nullptr;
+    }
+
+    sensors_filter filter{
+        NameFilter::from_config(config, "TemperaturePrinter", "include_chips", "exclude_chips"),
+        NameFilter::from_config(config, "TemperaturePrinter", "include_labels", "exclude_labels"),
+    };
+
+    auto *types = get_property_array(config, "TemperaturePrinter", "reading_types");
+    if (types) {
+        filter.types = 0;
+        for (auto it = types; *it; ++it) {
+            auto type = parse_sensor_type(*it);
+            if (type == 0)
+                errx(1, "%s on %s.%s%s", "Invalid value", "TemperaturePrinter", "reading_types", "");
+            filter.types |= type;
+        }
+        free_property_array(types);
+    }
+
+    return std::make_unique<TemperaturePrinter>(config, use_libsensors, std::move(filter));
 }
 } /* namespace swaystatus::modules */
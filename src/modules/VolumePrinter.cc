@@ -12,15 +12,13 @@ class VolumePrinter: public Base {
     ;
 
 public:
-    VolumePrinter(void *config, const char *mix_name, const char *card):
+    VolumePrinter(void *config):
         Base{
             config, "VolumePrinter"sv,
             1, "vol {volume}%", nullptr,
             "mix_name", "card"
         }
-    {
-        initialize_alsa_lib(mix_name, card);
-    }
+    {}
 
     void update()
     {
@@ -36,9 +34,19 @@ public:
 
 std::unique_ptr<Base> makeVolumePrinter(void *config)
 {
+    if (!load_alsa_lib()) {
+        warnx("%s is disabled", "VolumePrinter");
+        return nullptr;
+    }
+
     std::unique_ptr<const char[]> mix_name{get_property(config, "mix_name", "Master")};
     std::unique_ptr<const char[]> card    {get_property(config, "card",     "default")};
 
-    return std::make_unique<VolumePrinter>(config, mix_name.get(), card.get());
+    if (!initialize_alsa_lib(mix_name.get(), card.get())) {
+        warnx("%s is disabled", "VolumePrinter");
+        return nullptr;
+    }
+
+    return std::make_unique<VolumePrinter>(config);
 }
 } /* namespace swaystatus::modules */
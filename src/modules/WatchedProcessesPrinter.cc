@@ -0,0 +1,75 @@
+#include <err.h>
+
+#include "../process_configuration.h"
+#include "../poller.h"
+#include "../formatting/Conditional.hpp"
+#include "../process_watcher.hpp"
+
+#include "WatchedProcessesPrinter.hpp"
+
+using namespace std::literals;
+
+namespace swaystatus::modules {
+class WatchedProcessesPrinter: public Base {
+    ProcessWatcher watcher;
+
+    static void on_exit(int fd, enum Event, void *data)
+    {
+        auto *self = static_cast<WatchedProcessesPrinter*>(data);
+
+        self->watcher.handle_exit(fd);
+        self->request_immediate_update();
+    }
+
+public:
+    WatchedProcessesPrinter(void *config, NameFilter &&filter, std::uint32_t rescan_interval):
+        Base{
+            config, "WatchedProcessesPrinter"sv,
+            5,
+            "{is_running:{per_process_fmt_str:{comm} {cpu_usage}% {rss}}}"
+            "{is_not_running:Not running}",
+            "{is_running:{per_process_fmt_str:{comm}}}",
+            "names", "rescan_interval"
+        },
+        watcher{std::move(filter), rescan_interval, on_exit, this}
+    {}
+
+    void update()
+    {
+        watcher.update();
+    }
+    void do_print(const char *format)
+    {
+        const auto &processes = watcher.get_processes();
+
+        print(
+            format,
+            fmt::arg("running_count",       processes.size()),
+            fmt::arg("is_running",          Conditional{!processes.empty()}),
+            fmt::arg("is_not_running",      Conditional{processes.empty()}),
+            fmt::arg("per_process_fmt_str", processes)
+        );
+    }
+    void reload()
+    {}
+};
+
+std::unique_ptr<Base> makeWatchedProcessesPrinter(void *config)
+{
+    auto *names = get_property_array(config, "WatchedProcessesPrinter", "names");
+    if (!names)
+        errx(1, "%s on %s.%s%s", "Missing property", "WatchedProcessesPrinter", "names", "");
+
+    NameFilter filter{names, nullptr};
+    free_property_array(names);
+
+    auto rescan_interval = get_uint_property(
+        config, "WatchedProcessesPrinter", "rescan_interval", 60
+    );
+    if (rescan_interval == 0)
+        errx(1, "%s on %s.%s%s",
+                "Zero is not accepted", "WatchedProcessesPrinter", "rescan_interval", "");
+
+    return std::make_unique<WatchedProcessesPrinter>(config, std::move(filter), rescan_interval);
+}
+} /* namespace swaystatus::modules */
@@ -0,0 +1,10 @@
+#ifndef  __swaystatus_WatchedProcessesPrinter_HPP__
+# define __swaystatus_WatchedProcessesPrinter_HPP__
+
+# include "Base.hpp"
+
+namespace swaystatus::modules {
+std::unique_ptr<Base> makeWatchedProcessesPrinter(void *config);
+} /* namespace swaystatus::modules */
+
+#endif
@@ -0,0 +1,254 @@
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>         /* For O_RDONLY */
+#include <unistd.h>        /* For pread */
+#include <sys/statvfs.h>
+
+#include <cstring>
+
+#include "utility.h"
+#include "mem_size_t.hpp"
+#include "formatting/fmt_utility.hpp"
+#include "formatting/Conditional.hpp"
+#include "mounts.hpp"
+
+namespace swaystatus {
+static constexpr const char *mountinfo_path = "/proc/self/mountinfo";
+
+static auto get_percentage(std::uint64_t used, std::uint64_t avail) noexcept -> std::uint8_t
+{
+    if (used + avail == 0)
+        return 0;
+    // Round up like df
+    return static_cast<std::uint8_t>((used * 100 + used + avail - 1) / (used + avail));
+}
+
+/**
+ * Remove repeated and trailing '/', e.g. "/mnt//usb/" becomes "/mnt/usb".
+ */
+static auto normalize_path(std::string_view path) -> std::string
+{
+    std::string result;
+    result.reserve(path.size());
+
+    for (char c: path) {
+        if (c == '/' && result.size() != 0 && result.back() == '/')
+            continue;
+        result.push_back(c);
+    }
+    if (result.size() > 1 && result.back() == '/')
+        result.pop_back();
+
+    return result;
+}
+
+MountPoint::MountPoint(std::string_view path):
+    path{normalize_path(path)}
+{}
+
+bool MountPoint::is_available() const noexcept
+{
+    return available;
+}
+bool MountPoint::is_mounted() const noexcept
+{
+    return fstype.size() != 0;
+}
+
+/**
+ * Split one field of a line of /proc/self/mountinfo and unescape "\ooo" in place.
+ *
+ * @param p must point to the start of a field.
+ * @return start of the next field, or nullptr if it is the last field of the line.
+ */
+static auto next_field(char *p, std::string_view &field) noexcept -> char*
+{
+    char *out = p;
+    const char *start = p;
+
+    for (; *p != ' ' && *p != '\n' && *p != '\0'; ++p) {
+        if (p[0] == '\\' && '0' <= p[1] && p[1] <= '3' && '0' <= p[2] && p[2] <= '7' &&
+            '0' <= p[3] && p[3] <= '7')
+        {
+            *out++ = static_cast<char>((p[1] - '0') << 6 | (p[2] - '0') << 3 | (p[3] - '0'));
+            p += 3;
+        } else
+            *out++ = *p;
+    }
+
+    field = std::string_view{start, static_cast<std::size_t>(out - start)};
+
+    return *p == ' ' ? p + 1 : nullptr;
+}
+
+MountPoints::MountPoints(const char * const *paths):
+    mountinfo_fd{openat_checked("", AT_FDCWD, mountinfo_path, O_RDONLY)}
+{
+    for (auto it = paths; *it; ++it)
+        mount_points.emplace_back(*it);
+}
+
+int MountPoints::get_mountinfo_fd() const noexcept
+{
+    return mountinfo_fd.get();
+}
+void MountPoints::handle_notification() noexcept
+{
+    mount_table_changed = true;
+}
+
+std::size_t MountPoints::read_mountinfo()
+{
+    ssize_t len = aspreadall(mountinfo_fd.get(), buffer);
+    if (len == -1)
+        err(1, "%s on %s failed", "pread", mountinfo_path);
+
+    return len;
+}
+
+void MountPoints::resolve()
+{
+    for (auto &mount_point: mount_points) {
+        mount_point.device.clear();
+        mount_point.fstype.clear();
+    }
+
+    read_mountinfo();
+
+    char *line = buffer.data();
+    while (*line != '\0') {
+        char *newline = std::strchr(line, '\n');
+        if (newline)
+            *newline = '\0';
+
+        // Format: id parent_id major:minor root mount_point options [optional...] - fstype source
+        std::string_view target;
+        char *p = line;
+        for (int i = 0; p && i != 5; ++i)
+            p = next_field(p, target);
+
+        char *separator = p ? std::strstr(p, " - ") : nullptr;
+        if (separator) {
+            std::string_view fstype, source;
+            p = next_field(separator + 3, fstype);
+            if (p)
+                next_field(p, source);
+
+            // Later lines are mounted on top of earlier ones, so the last match wins.
+            for (auto &mount_point: mount_points) {
+                if (mount_point.path == target) {
+                    mount_point.fstype = fstype;
+                    mount_point.device = source;
+                }
+            }
+        }
+
+        if (!newline)
+            break;
+        line = newline + 1;
+    }
+}
+
+void MountPoints::update()
+{
+    if (mount_table_changed) {
+        mount_table_changed = false;
+        resolve();
+    }
+
+    max_percent = 0;
+
+    for (auto &mount_point: mount_points) {
+        struct statvfs stat;
+
+        // statvfs on a path that is not a mount point reports the filesystem containing it.
+        mount_point.available = mount_point.is_mounted() &&
+                                statvfs(mount_point.path.c_str(), &stat) == 0;
+        if (!mount_point.available) {
+            mount_point.total = mount_point.used = mount_point.free = 0;
+            mount_point.percent = mount_point.inodes_percent = 0;
+            continue;
+        }
+
+        const std::uint64_t frsize = stat.f_frsize;
+        mount_point.total = stat.f_blocks * frsize;
+        mount_point.used = (stat.f_blocks - stat.f_bfree) * frsize;
+        mount_point.free = stat.f_bavail * frsize;
+        mount_point.percent = get_percentage(mount_point.used, mount_point.free);
+        mount_point.inodes_percent = get_percentage(stat.f_files - stat.f_ffree, stat.f_favail);
+
+        if (mount_point.percent > max_percent)
+            max_percent = mount_point.percent;
+    }
+}
+
+auto MountPoints::get_max_percent() const noexcept -> std::uint8_t
+{
+    return max_percent;
+}
+
+auto MountPoints::size() const noexcept -> std::size_t
+{
+    return mount_points.size();
+}
+auto MountPoints::begin() const noexcept -> const_iterator
+{
+    return mount_points.begin();
+}
+auto MountPoints::end() const noexcept -> const_iterator
+{
+    return mount_points.end();
+}
+} /* namespace swaystatus */
+
+using MountPoints_formatter = fmt::formatter<swaystatus::MountPoints>;
+
+auto MountPoints_formatter::parse(format_parse_context &ctx) -> format_parse_context_it
+{
+    auto it = ctx.begin(), end = ctx.end();
+    if (it == end)
+        return it;
+
+    end = swaystatus::find_end_of_format(ctx);
+
+    fmt_str = std::string_view{it, static_cast<std::size_t>(end - it)};
+
+    return end;
+}
+auto MountPoints_formatter::format(const MountPoints &mount_points, format_context &ctx)
+    -> format_context_it
+{
+    using swaystatus::Conditional;
+    using swaystatus::mem_size_t;
+
+    auto out = ctx.out();
+
+    if (fmt_str.size() == 0)
+        return out;
+
+    std::size_t i = 0;
+    for (const auto &mount_point: mount_points) {
+        out = format_to(
+            out,
+            fmt_str,
+            fmt::arg("mount_point",  mount_point.path),
+            fmt::arg("device",       mount_point.device),
+            fmt::arg("fstype",       mount_point.fstype),
+            fmt::arg("is_available", Conditional{mount_point.is_available()}),
+            fmt::arg("is_mounted",   Conditional{mount_point.is_mounted()}),
+
+            fmt::arg("total",          mem_size_t{mount_point.total}),
+            fmt::arg("used",           mem_size_t{mount_point.used}),
+            fmt::arg("free",           mem_size_t{mount_point.free}),
+            fmt::arg("percent",        mount_point.percent),
+            fmt::arg("inodes_percent", mount_point.inodes_percent)
+        );
+
+        if (++i != mount_points.size()) {
+            *out = ' ';
+            ++out;
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,127 @@
+#ifndef  __swaystatus_mounts_HPP__
+# define __swaystatus_mounts_HPP__
+
+# include <cstddef>
+# include <cstdint>
+# include <string>
+# include <string_view>
+# include <vector>
+
+# include "Fd.hpp"
+
+# include "formatting/fmt_config.hpp"
+# include "formatting/fmt/include/fmt/format.h"
+
+namespace swaystatus {
+struct MountPoint {
+    /**
+     * Normalized without repeated or trailing '/' to match /proc/self/mountinfo.
+     *
+     * It is not kept open, otherwise it would be busy and cannot be unmounted.
+     */
+    std::string path;
+
+    /**
+     * true if path is a mount point and statvfs on it succeeded in the last update.
+     */
+    bool available = false;
+
+    /**
+     * Read from /proc/self/mountinfo, empty if path is not a mount point.
+     */
+    std::string device;
+    std::string fstype;
+
+    /**
+     * In bytes
+     */
+    std::uint64_t total = 0;
+    std::uint64_t used = 0;
+    /**
+     * Available to unprivileged users
+     */
+    std::uint64_t free = 0;
+    /**
+     * used / (used + free) in percentage, same as df.
+     */
+    std::uint8_t percent = 0;
+    std::uint8_t inodes_percent = 0;
+
+    MountPoint(std::string_view path);
+
+    bool is_available() const noexcept;
+    bool is_mounted() const noexcept;
+};
+
+/**
+ * MountPoints runs statvfs on configured mount points on every update and reads their
+ * device and fstype only when /proc/self/mountinfo reports the mount table is changed
+ * via POLLPRI.
+ */
+class MountPoints {
+    std::vector<MountPoint> mount_points;
+
+    Fd mountinfo_fd;
+    /**
+     * It only grows when /proc/self/mountinfo is larger than ever seen.
+     */
+    std::vector<char> buffer = std::vector<char>(4096);
+
+    bool mount_table_changed = true;
+
+    std::uint8_t max_percent = 0;
+
+    /**
+     * @return length of content read
+     */
+    std::size_t read_mountinfo();
+    void resolve();
+
+public:
+    using const_iterator = typename std::vector<MountPoint>::const_iterator;
+
+    /**
+     * @param paths NULL-terminated array
+     */
+    MountPoints(const char * const *paths);
+
+    MountPoints(MountPoints&&) = default;
+    MountPoints& operator = (MountPoints&&) = default;
+
+    ~MountPoints() = default;
+
+    /**
+     * Poll it for pri_ready to get notified of changes of mount table.
+     */
+    int get_mountinfo_fd() const noexcept;
+    /**
+     * Mark the mount table as changed, /proc/self/mountinfo is read again in next update().
+     */
+    void handle_notification() noexcept;
+
+    void update();
+
+    auto get_max_percent() const noexcept -> std::uint8_t;
+
+    auto size() const noexcept -> std::size_t;
+
+    auto begin() const noexcept -> const_iterator;
+    auto end() const noexcept -> const_iterator;
+};
+} /* namespace swaystatus */
+
+template <>
+struct fmt::formatter<swaystatus::MountPoints>
+{
+    using MountPoints = swaystatus::MountPoints;
+
+    using format_parse_context_it = typename format_parse_context::iterator;
+    using format_context_it = typename format_context::iterator;
+
+    std::string_view fmt_str = "";
+
+    auto parse(format_parse_context &ctx) -> format_parse_context_it;
+    auto format(const MountPoints &mount_points, format_context &ctx) -> format_context_it;
+};
+
+#endif
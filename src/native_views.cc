@@ -0,0 +1,30 @@
+#include "native_views.hpp"
+
+namespace swaystatus {
+auto NativeView::get() -> std::shared_ptr<const NativeSnapshot>
+{
+    is_subscribed.store(true, std::memory_order_relaxed);
+
+    std::lock_guard lock{mutex};
+    return latest;
+}
+
+static NativeView meminfo_view;
+static NativeView battery_view;
+static NativeView network_view;
+
+static const std::pair<std::string_view, NativeView*> views[] = {
+    {"meminfo", &meminfo_view},
+    {"battery", &battery_view},
+    {"network", &network_view},
+};
+
+auto get_native_view(std::string_view name) noexcept -> NativeView*
+{
+    for (const auto &[view_name, view]: views) {
+        if (view_name == name)
+            return view;
+    }
+    return nullptr;
+}
+} /* namespace swaystatus */
@@ -0,0 +1,98 @@
+#ifndef  __swaystatus_native_views_HPP__
+# define __swaystatus_native_views_HPP__
+
+# include <cstddef>
+# include <atomic>
+# include <memory>
+# include <mutex>
+# include <string>
+# include <string_view>
+# include <utility>
+
+namespace swaystatus {
+/**
+ * Snapshot of data collected by a module, e.g. the content of /proc/meminfo.
+ */
+struct NativeSnapshot {
+    std::string data;
+    /**
+     * Format of each item in the syntax of python module struct, "B" for text.
+     */
+    const char *format = "B";
+    std::size_t itemsize = 1;
+};
+
+/**
+ * NativeView is where a module publishes snapshots of the data it collects, so that python
+ * callbacks can read them through the builtin module `swaystatus` instead of doing the I/O
+ * again.
+ *
+ * Snapshots are immutable once published and shared by reference, so a reader on any thread
+ * keeps the one it gets alive while the writer publishes new ones.
+ * Nothing is published until the first reader asks for it.
+ */
+class NativeView {
+    std::atomic<bool> is_subscribed{false};
+
+    std::mutex mutex;
+    std::shared_ptr<NativeSnapshot> latest;
+    /**
+     * Snapshot published before latest, only accessed by the writer.
+     */
+    std::shared_ptr<NativeSnapshot> spare;
+
+public:
+    NativeView() = default;
+
+    NativeView(const NativeView&) = delete;
+    NativeView& operator = (const NativeView&) = delete;
+
+    ~NativeView() = default;
+
+    /**
+     * Called by the writer.
+     *
+     * @param fill called with the snapshot to fill only if there is any reader, it might
+     *             contain the value published before.
+     */
+    template <class F>
+    void publish(F &&fill)
+    {
+        if (!is_subscribed.load(std::memory_order_relaxed))
+            return;
+
+        std::shared_ptr<NativeSnapshot> snapshot;
+        // Reuse the spare once no reader holds it, so that no allocation is needed.
+        if (spare && spare.use_count() == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            snapshot = std::move(spare);
+        } else
+            snapshot = std::make_shared<NativeSnapshot>();
+
+        fill(*snapshot);
+
+        std::lock_guard lock{mutex};
+        spare = std::exchange(latest, std::move(snapshot));
+    }
+
+    /**
+     * Called by readers, thread safe.
+     *
+     * @return the latest snapshot, or nullptr if nothing is published since the first call.
+     */
+    auto get() -> std::shared_ptr<const NativeSnapshot>;
+};
+
+/**
+ * Views available:
+ *  - "meminfo": content of /proc/meminfo, published by memory_usage
+ *  - "battery": uevent of each battery, published by battery
+ *  - "network": struct interface_stats_record of each interface, published by
+ *    network_interface
+ *
+ * @return nullptr if there is no view named name.
+ */
+auto get_native_view(std::string_view name) noexcept -> NativeView*;
+} /* namespace swaystatus */
+
+#endif
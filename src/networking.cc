@@ -1,5 +1,6 @@
 #include <arpa/inet.h>
 #include <net/if.h>
+#include <netpacket/packet.h>
 #include <ifaddrs.h>
 
 #include <err.h>
@@ -9,109 +10,124 @@
 #include <climits>
 #include <cerrno>
 #include <algorithm>
+#include <utility>
 
 #include "utility.h"
 #include "formatting/fmt_utility.hpp"
 #include "formatting/Conditional.hpp"
+#include "formatting/LazyEval.hpp"
 #include "mem_size_t.hpp"
 #include "networking.hpp"
 
 #include "formatting/fmt/include/fmt/core.h"
 
 using swaystatus::Conditional;
+using swaystatus::LazyEval;
 using swaystatus::mem_size_t;
 using swaystatus::find_end_of_format;
 
 namespace swaystatus {
-void ipv4_addrs::add(const struct sockaddr *src_addr) noexcept
+auto ipv4_addrs::begin() const noexcept -> const_iterator
 {
-    if (cnt == array.size())
-        return;
-
-    ++cnt;
-    auto &dest_ipv4_addr = array[cnt - 1];
-    auto &src_ipv4_addr = *reinterpret_cast<const struct sockaddr_in*>(src_addr);
-
-    dest_ipv4_addr = src_ipv4_addr.sin_addr;
+    return array;
 }
-void ipv4_addrs::reset() noexcept
+auto ipv4_addrs::end() const noexcept -> const_iterator
 {
-    cnt = 0;
+    return begin() + cnt;
 }
-auto ipv4_addrs::begin() const noexcept -> const_iterator
+auto ipv6_addrs::begin() const noexcept -> const_iterator
 {
-    return array.begin();
+    return array;
 }
-auto ipv4_addrs::end() const noexcept -> const_iterator
+auto ipv6_addrs::end() const noexcept -> const_iterator
 {
     return begin() + cnt;
 }
-void ipv6_addrs::add(const struct sockaddr *src_addr) noexcept
-{
-    if (cnt == array.size())
-        return;
 
-    ++cnt;
-    auto &dest_ipv6_addr = array[cnt - 1];
-    auto &src_ipv6_addr = *reinterpret_cast<const struct sockaddr_in6*>(src_addr);
+auto get_addr_scope(const ipv4_addr &addr) noexcept -> addr_scope
+{
+    const std::uint32_t val = ntohl(addr.s_addr);
 
-    dest_ipv6_addr = src_ipv6_addr.sin6_addr;
+    if ((val >> 24) == 127)
+        return addr_scope_host;
+    if ((val >> 16) == ((169 << 8) | 254))
+        return addr_scope_link;
+    return addr_scope_global;
 }
-void ipv6_addrs::reset() noexcept
+auto get_addr_scope(const ipv6_addr &addr) noexcept -> addr_scope
 {
-    cnt = 0;
+    const auto *bytes = addr.s6_addr;
+
+    if (IN6_IS_ADDR_LOOPBACK(&addr))
+        return addr_scope_host;
+    if (IN6_IS_ADDR_LINKLOCAL(&addr))
+        return addr_scope_link;
+    if (IN6_IS_ADDR_SITELOCAL(&addr) || (bytes[0] & 0xfe) == 0xfc)
+        return addr_scope_site;
+    return addr_scope_global;
 }
-auto ipv6_addrs::begin() const noexcept -> const_iterator
+auto parse_addr_scope(const char *str) noexcept -> std::uint8_t
 {
-    return array.begin();
+    if (std::strcmp(str, "host") == 0)
+        return addr_scope_host;
+    if (std::strcmp(str, "link") == 0)
+        return addr_scope_link;
+    if (std::strcmp(str, "site") == 0)
+        return addr_scope_site;
+    if (std::strcmp(str, "global") == 0)
+        return addr_scope_global;
+    return 0;
 }
-auto ipv6_addrs::end() const noexcept -> const_iterator
+
+interface_rates_history::interface_rates_history(std::size_t window):
+    rx_bytes{window},
+    tx_bytes{window},
+    rx_packets{window},
+    tx_packets{window}
+{}
+void interface_rates_history::push(const interface_rates &rates) noexcept
 {
-    return begin() + cnt;
+    rx_bytes.push(rates.rx_bytes);
+    tx_bytes.push(rates.tx_bytes);
+    rx_packets.push(rates.rx_packets);
+    tx_packets.push(rates.tx_packets);
 }
-
-interface_stats Interface::get_empty_stats() noexcept
+void interface_rates_history::clear() noexcept
 {
-    interface_stats stats;
-    std::memset(&stats, 0, sizeof(stats));
-    return stats;
+    rx_bytes.clear();
+    tx_bytes.clear();
+    rx_packets.clear();
+    tx_packets.clear();
 }
 
-bool Interface::operator == (std::string_view interface_name) const noexcept
+Interfaces::const_iterator::const_iterator(const Interfaces *interfaces, std::size_t i) noexcept:
+    interfaces{interfaces}, i{i}
+{}
+auto Interfaces::const_iterator::operator * () const noexcept -> Interface
 {
-    return name == interface_name;
+    return (*interfaces)[i];
 }
-bool Interface::operator != (std::string_view interface_name) const noexcept
+auto Interfaces::const_iterator::operator ++ () noexcept -> const_iterator&
 {
-    return !(*this == interface_name);
+    ++i;
+    return *this;
 }
-
-void Interface::reset() noexcept
+bool Interfaces::const_iterator::operator == (const const_iterator &other) const noexcept
 {
-    /*
-     * name and flags will be overwriten anyway, so it's ok to not reset them.
-     */
-    stat = get_empty_stats();
-    ipv4_addrs_v.reset();
-    ipv6_addrs_v.reset();
+    return i == other.i;
 }
-
-auto Interfaces::operator [] (std::string_view name) noexcept -> iterator
+bool Interfaces::const_iterator::operator != (const const_iterator &other) const noexcept
 {
-    auto it = std::find(interfaces.begin(), interfaces.begin() + cnt, name);
-    if (it != interfaces.begin() + cnt)
-        return it;
-
-    if (cnt == interfaces.size())
-        return end();
-
-    ++cnt;
-    auto &interface = interfaces[cnt - 1];
-    interface.name = name;
-
-    return end() - 1;
+    return !(*this == other);
 }
 
+Interfaces::Interfaces(
+    std::size_t rate_window, std::size_t max_interfaces,
+    interfaces_filter &&filter
+):
+    rate_window{rate_window}, max_interfaces{max_interfaces}, filter{std::move(filter)}
+{}
+
 bool Interfaces::is_empty() const noexcept
 {
     return cnt == 0;
@@ -121,86 +137,311 @@ auto Interfaces::size() const noexcept -> std::size_t
     return cnt;
 }
 
-auto Interfaces::begin() noexcept -> iterator
+auto Interfaces::get_routes() noexcept -> DefaultRoutes&
 {
-    return interfaces.begin();
+    return routes;
 }
-auto Interfaces::end() noexcept -> iterator
+
+auto Interfaces::operator [] (std::size_t i) const noexcept -> Interface
 {
-    return begin() + cnt;
+    const auto &name = names[i];
+    const auto ifindex = ifindices[i];
+    const auto ipv4_range = ipv4_ranges[i];
+    const auto ipv6_range = ipv6_ranges[i];
+
+    return {
+        std::string_view{name.data(), strnlen(name.data(), name.size())},
+        flags[i],
+        ifindex,
+        stats[i],
+        ipv4_addrs{{}, ipv4_arena.data() + ipv4_range.begin, ipv4_range.cnt},
+        ipv6_addrs{{}, ipv6_arena.data() + ipv6_range.begin, ipv6_range.cnt},
+        rates[i],
+        rates_histories[i],
+        ifindex != 0 && ifindex == routes.get_primary_ifindex(),
+        routes.find(ifindex)
+    };
 }
 
 auto Interfaces::begin() const noexcept -> const_iterator
 {
-    return interfaces.begin();
+    return {this, 0};
 }
 auto Interfaces::end() const noexcept -> const_iterator
 {
-    return begin() + cnt;
+    return {this, cnt};
 }
 
 auto Interfaces::cbegin() const noexcept -> const_iterator
 {
-    return interfaces.cbegin();
+    return begin();
 }
 auto Interfaces::cend() const noexcept -> const_iterator
 {
-    return cbegin() + cnt;
+    return end();
 }
 
-void Interfaces::clear() noexcept
+auto Interfaces::find_or_add_row(const char *name) -> std::size_t
+{
+    for (std::size_t i = 0; i != cnt; ++i) {
+        if (std::strncmp(names[i].data(), name, IFNAMSIZ) == 0)
+            return i;
+    }
+
+    if (cnt == max_interfaces)
+        return max_interfaces;
+
+    if (cnt == names.size()) {
+        // Grow the table, this only happens when there are more interfaces than ever seen
+        names.emplace_back();
+        flags.emplace_back();
+        ifindices.emplace_back();
+        states.emplace_back();
+        stats.emplace_back();
+        prev_stats.emplace_back();
+        ipv4_ranges.emplace_back();
+        ipv6_ranges.emplace_back();
+        rates.emplace_back();
+        rates_histories.emplace_back(rate_window);
+    } else
+        rates_histories[cnt].clear();
+
+    const auto i = cnt++;
+
+    std::strncpy(names[i].data(), name, IFNAMSIZ);
+    names[i].back() = '\0';
+    ifindices[i] = 0;
+    states[i] = 0;
+    rates[i] = interface_rates{};
+
+    return i;
+}
+void Interfaces::swap_rows(std::size_t i, std::size_t j) noexcept
 {
-    for (auto &interface: *this)
-        interface.reset();
+    using std::swap;
+
+    swap(names[i], names[j]);
+    swap(flags[i], flags[j]);
+    swap(ifindices[i], ifindices[j]);
+    swap(states[i], states[j]);
+    swap(stats[i], stats[j]);
+    swap(prev_stats[i], prev_stats[j]);
+    swap(ipv4_ranges[i], ipv4_ranges[j]);
+    swap(ipv6_ranges[i], ipv6_ranges[j]);
+    swap(rates[i], rates[j]);
+    swap(rates_histories[i], rates_histories[j]);
+}
 
+/**
+ * Counters in rtnl_link_stats are only 32-bit wide, so they wrap around quite often on
+ * a busy link.
+ *
+ * If the modular difference is less than 2^31, then it is treated as a wrap around,
+ * otherwise the counter is considered to be reset (e.g. driver reloaded).
+ *
+ * @return false if the counter is reset.
+ */
+static bool get_counter_delta(std::uint32_t prev, std::uint32_t curr, std::uint64_t *delta) noexcept
+{
+    std::uint32_t diff = curr - prev;
+    if (curr < prev && diff >= (UINT32_C(1) << 31))
+        return false;
+
+    *delta = diff;
+    return true;
+}
+void Interfaces::update_rates(std::size_t i, std::uint64_t elapsed) noexcept
+{
+    rates[i] = interface_rates{};
+
+    if ((states[i] & (has_stat | has_prev_stat)) != (has_stat | has_prev_stat) || elapsed == 0)
+        return;
+
+    const auto &prev_stat = prev_stats[i];
+    const auto &stat = stats[i];
+
+    std::uint64_t rx_bytes, tx_bytes, rx_packets, tx_packets;
+    if (!get_counter_delta(prev_stat.rx_bytes,   stat.rx_bytes,   &rx_bytes)   ||
+        !get_counter_delta(prev_stat.tx_bytes,   stat.tx_bytes,   &tx_bytes)   ||
+        !get_counter_delta(prev_stat.rx_packets, stat.rx_packets, &rx_packets) ||
+        !get_counter_delta(prev_stat.tx_packets, stat.tx_packets, &tx_packets))
+    {
+        /* The interface is reset, samples collected so far are now meaningless */
+        rates_histories[i].clear();
+        return;
+    }
+
+    /* delta < 2^32, thus delta * 10^9 can never overflow */
+    auto &rate = rates[i];
+    rate.rx_bytes   = rx_bytes   * 1000 * 1000 * 1000 / elapsed;
+    rate.tx_bytes   = tx_bytes   * 1000 * 1000 * 1000 / elapsed;
+    rate.rx_packets = rx_packets * 1000 * 1000 * 1000 / elapsed;
+    rate.tx_packets = tx_packets * 1000 * 1000 * 1000 / elapsed;
+
+    rates_histories[i].push(rate);
+}
+
+void Interfaces::clear() noexcept
+{
     cnt = 0;
+    ipv4_arena.clear();
+    ipv6_arena.clear();
+}
+bool Interfaces::is_interested_entry(const struct ifaddrs *ifa) const noexcept
+{
+    if (ifa->ifa_addr == nullptr)
+        return false;
+
+    auto ifa_flags = ifa->ifa_flags;
+    if (ifa_flags & IFF_LOOPBACK)
+        return false;
+    if (!(ifa_flags & IFF_UP))
+        return false;
+    if (!(ifa_flags & IFF_RUNNING))
+        return false;
+
+    switch (ifa->ifa_addr->sa_family) {
+        case AF_INET: {
+            auto &addr = reinterpret_cast<const struct sockaddr_in*>(ifa->ifa_addr)->sin_addr;
+            if (!(get_addr_scope(addr) & filter.addr_scopes))
+                return false;
+            break;
+        }
+
+        case AF_INET6: {
+            auto &addr = reinterpret_cast<const struct sockaddr_in6*>(ifa->ifa_addr)->sin6_addr;
+            if (!(get_addr_scope(addr) & filter.addr_scopes))
+                return false;
+            break;
+        }
+
+        case AF_PACKET:
+            break;
+
+        default:
+            return false;
+    }
+
+    if (filter.primary_only && std::strcmp(ifa->ifa_name, routes.get_primary_name()) != 0)
+        return false;
+
+    return filter.names.matches(ifa->ifa_name);
 }
 void Interfaces::update()
 {
-    clear();
-    
+    routes.update();
+
+    for (std::size_t i = 0; i != cnt; ++i) {
+        auto &state = states[i];
+
+        // Keep the stat for calculating rates
+        if (state & has_stat) {
+            prev_stats[i] = stats[i];
+            state = has_prev_stat;
+        } else
+            state = 0;
+
+        ipv4_ranges[i] = addr_range{0, 0};
+        ipv6_ranges[i] = addr_range{0, 0};
+    }
+
     struct ifaddrs *ifaddr;
     if (getifaddrs(&ifaddr) < 0)
         err(1, "%s failed", "getifaddrs");
-    
+
+    entry_rows.clear();
+
+    // First pass: find the rows and count the addresses of every interface
     for (auto *ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
-        // Filter out uninterested entries
-        if (ifa->ifa_addr == nullptr)
-            continue;
-    
-        auto ifa_flags = ifa->ifa_flags;
-        if (ifa_flags & IFF_LOOPBACK)
-            continue;
-        if (!(ifa_flags & IFF_UP))
-            continue;
-        if (!(ifa_flags & IFF_RUNNING))
+        if (!is_interested_entry(ifa))
             continue;
-    
-        auto sa_family = ifa->ifa_addr->sa_family;
-        if (sa_family != AF_INET && sa_family != AF_INET6 && sa_family != AF_PACKET)
+
+        auto i = find_or_add_row(ifa->ifa_name);
+        entry_rows.push_back(i);
+        if (i == max_interfaces) // If it is full, then ignore the interface
             continue;
 
-        // Add new interface
-        auto *interface = (*this)[ifa->ifa_name];
-        if (!interface) // If it is full, then stop getting more
-            break;
-        interface->flags = ifa->ifa_flags;
-        switch (sa_family) {
+        states[i] |= present;
+        flags[i] = ifa->ifa_flags;
+        switch (ifa->ifa_addr->sa_family) {
             case AF_INET:
-                interface->ipv4_addrs_v.add(ifa->ifa_addr);
+                ++ipv4_ranges[i].cnt;
                 break;
     
             case AF_INET6:
-                interface->ipv6_addrs_v.add(ifa->ifa_addr);
+                ++ipv6_ranges[i].cnt;
                 break;
     
             case AF_PACKET:
-                interface->stat = *static_cast<interface_stats*>(ifa->ifa_data);
+                ifindices[i] = reinterpret_cast<const struct sockaddr_ll*>(ifa->ifa_addr)->sll_ifindex;
+                stats[i] = *static_cast<interface_stats*>(ifa->ifa_data);
+                states[i] |= has_stat;
                 break;
         }
     }
+
+    // Remove interfaces that are gone or down by moving them to the back of the table
+    std::size_t new_cnt = 0;
+    for (std::size_t i = 0; i != cnt; ++i) {
+        if (states[i] & present) {
+            if (i != new_cnt) {
+                swap_rows(i, new_cnt);
+                std::replace(entry_rows.begin(), entry_rows.end(), i, new_cnt);
+            }
+            ++new_cnt;
+        }
+    }
+    cnt = new_cnt;
+
+    // Assign ranges in the arenas
+    std::uint32_t ipv4_cnt = 0, ipv6_cnt = 0;
+    for (std::size_t i = 0; i != cnt; ++i) {
+        ipv4_ranges[i].begin = ipv4_cnt;
+        ipv4_cnt += ipv4_ranges[i].cnt;
+        ipv4_ranges[i].cnt = 0;
+
+        ipv6_ranges[i].begin = ipv6_cnt;
+        ipv6_cnt += ipv6_ranges[i].cnt;
+        ipv6_ranges[i].cnt = 0;
+    }
+    ipv4_arena.resize(ipv4_cnt);
+    ipv6_arena.resize(ipv6_cnt);
+
+    // Second pass: fill the arenas
+    std::size_t entry = 0;
+    for (auto *ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
+        if (!is_interested_entry(ifa))
+            continue;
+
+        auto i = entry_rows[entry++];
+        if (i == max_interfaces)
+            continue;
+
+        switch (ifa->ifa_addr->sa_family) {
+            case AF_INET: {
+                auto &range = ipv4_ranges[i];
+                auto &src = *reinterpret_cast<const struct sockaddr_in*>(ifa->ifa_addr);
+                ipv4_arena[range.begin + range.cnt++] = src.sin_addr;
+                break;
+            }
     
+            case AF_INET6: {
+                auto &range = ipv6_ranges[i];
+                auto &src = *reinterpret_cast<const struct sockaddr_in6*>(ifa->ifa_addr);
+                ipv6_arena[range.begin + range.cnt++] = src.sin6_addr;
+                break;
+            }
+        }
+    }
+
     freeifaddrs(ifaddr);
+
+    const auto timestamp = get_monotonic_timestamp();
+    const auto elapsed = prev_timestamp == 0 ? 0 : timestamp - prev_timestamp;
+    prev_timestamp = timestamp;
+
+    for (std::size_t i = 0; i != cnt; ++i)
+        update_rates(i, elapsed);
 }
 } /* namespace swaystatus */
 
@@ -226,6 +467,9 @@ auto Interfaces_formatter::format(const Interfaces &interfaces, format_context &
 
         std::size_t i = 0;
         for (const auto &interface: interfaces) {
+            const auto &history = interface.rates_history;
+            const auto *route = interface.route;
+
             out = format_to(
                 out,
                 fmt_str,
@@ -286,8 +530,27 @@ auto Interfaces_formatter::format(const Interfaces &interfaces, format_context &
 	            FMT_STAT(rx_compressed),
 	            FMT_STAT(tx_compressed),
 #undef  FMT_STAT
+
+#define FMT_RATE_LAZY(attr, type, func) \
+    LazyEval{[&history]() noexcept { return type{history.attr.func()}; }}
+#define FMT_RATE(name, attr, type)                                      \
+                fmt::arg(name,        type{interface.rates.attr}),      \
+                fmt::arg(name "_min", FMT_RATE_LAZY(attr, type, min)),  \
+                fmt::arg(name "_max", FMT_RATE_LAZY(attr, type, max)),  \
+                fmt::arg(name "_avg", FMT_RATE_LAZY(attr, type, avg))
+                FMT_RATE("rx_rate",         rx_bytes,   mem_size_t),
+                FMT_RATE("tx_rate",         tx_bytes,   mem_size_t),
+                FMT_RATE("rx_packets_rate", rx_packets, std::uint64_t),
+                FMT_RATE("tx_packets_rate", tx_packets, std::uint64_t),
+#undef  FMT_RATE
+#undef  FMT_RATE_LAZY
+
                 fmt::arg("ipv4_addrs", interface.ipv4_addrs_v),
-                fmt::arg("ipv6_addrs", interface.ipv6_addrs_v)
+                fmt::arg("ipv6_addrs", interface.ipv6_addrs_v),
+
+                fmt::arg("is_primary", Conditional{interface.is_primary}),
+                fmt::arg("gateway", route ? route->gateway : swaystatus::gateway_addr{}),
+                fmt::arg("route_metric", route ? route->metric : 0)
             );
 
             if (++i != interfaces.size()) {
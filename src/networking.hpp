@@ -6,15 +6,24 @@
 # include <sys/types.h>
 # include <netinet/in.h>
 # include <netinet/ip.h>
+# include <net/if.h>
 # include <linux/if_link.h>
 
 # include <cstddef>
+# include <cstdint>
 # include <string>
 # include <string_view>
 # include <array>
+# include <vector>
+
+# include "RingBuffer.hpp"
+# include "NameFilter.hpp"
+# include "routing.hpp"
 
 # include "formatting/fmt/include/fmt/format.h"
 
+struct ifaddrs;
+
 namespace swaystatus {
 using ipv4_addr = struct in_addr;
 using ipv6_addr = struct in6_addr;
@@ -23,73 +32,244 @@ using interface_stats = struct rtnl_link_stats;
 
 struct ip_addrs {};
 /**
- * It is unlikely for one computer to have more than 8 addresses.
+ * View of ip addresses of one interface stored in the arena of Interfaces.
+ *
+ * It is only valid until the next call to Interfaces::update().
  */
 struct ipv4_addrs: ip_addrs {
-    using const_iterator = typename std::array<ipv4_addr, 8>::const_iterator;
+    using const_iterator = const ipv4_addr*;
 
+    const ipv4_addr *array = nullptr;
     std::size_t cnt = 0;
-    std::array<ipv4_addr, 8> array;
-
-    void add(const struct sockaddr *src_addr) noexcept;
-    void reset() noexcept;
 
     auto begin() const noexcept -> const_iterator;
     auto end() const noexcept -> const_iterator;
 };
 struct ipv6_addrs: ip_addrs {
-    using const_iterator = typename std::array<ipv6_addr, 8>::const_iterator;
+    using const_iterator = const ipv6_addr*;
 
+    const ipv6_addr *array = nullptr;
     std::size_t cnt = 0;
-    std::array<ipv6_addr, 8> array;
-
-    void add(const struct sockaddr *src_addr) noexcept;
-    void reset() noexcept;
 
     auto begin() const noexcept -> const_iterator;
     auto end() const noexcept -> const_iterator;
 };
-struct Interface {
-    static interface_stats get_empty_stats() noexcept;
 
-    std::string name;
-    unsigned int flags;   /* Flags from SIOCGIFFLAGS */
+enum addr_scope: std::uint8_t {
+    /**
+     * loopback addresses
+     */
+    addr_scope_host   = 1 << 0,
+    /**
+     * 169.254.0.0/16 and fe80::/10
+     */
+    addr_scope_link   = 1 << 1,
+    /**
+     * fec0::/10 and fc00::/7
+     */
+    addr_scope_site   = 1 << 2,
+    addr_scope_global = 1 << 3,
+
+    addr_scope_all = addr_scope_host | addr_scope_link | addr_scope_site | addr_scope_global,
+};
+auto get_addr_scope(const ipv4_addr &addr) noexcept -> addr_scope;
+auto get_addr_scope(const ipv6_addr &addr) noexcept -> addr_scope;
+/**
+ * @param str can be "host", "link", "site" or "global"
+ * @return 0 if str is not a valid scope
+ */
+auto parse_addr_scope(const char *str) noexcept -> std::uint8_t;
+
+/**
+ * Filters applied while the results of getifaddrs are walked, thus
+ * filtered interfaces and addresses are never stored.
+ */
+struct interfaces_filter {
+    NameFilter names;
+    /**
+     * Bitwise or of addr_scope
+     */
+    std::uint8_t addr_scopes = addr_scope_all;
+    /**
+     * Only keep the interface carrying the traffic to the internet
+     */
+    bool primary_only = false;
+};
 
-    interface_stats stat = get_empty_stats();
+/**
+ * Item of the native view "network"
+ */
+struct interface_stats_record {
+    char name[IFNAMSIZ];
+    interface_stats stat;
+};
 
-    ipv4_addrs ipv4_addrs_v;
-    ipv6_addrs ipv6_addrs_v;
+/**
+ * Number of bytes/packets per second
+ */
+struct interface_rates {
+    std::uint64_t rx_bytes = 0;
+    std::uint64_t tx_bytes = 0;
+    std::uint64_t rx_packets = 0;
+    std::uint64_t tx_packets = 0;
+};
+struct interface_rates_history {
+    RingBuffer<std::uint64_t> rx_bytes;
+    RingBuffer<std::uint64_t> tx_bytes;
+    RingBuffer<std::uint64_t> rx_packets;
+    RingBuffer<std::uint64_t> tx_packets;
 
+    interface_rates_history() = default;
     /**
-     * operator == and != are used to find the interface.
+     * @param window number of samples to keep, must not be 0
      */
-    bool operator == (std::string_view interface_name) const noexcept;
-    bool operator != (std::string_view interface_name) const noexcept;
+    interface_rates_history(std::size_t window);
+
+    void push(const interface_rates &rates) noexcept;
+    void clear() noexcept;
+};
+
+/**
+ * A row of Interfaces.
+ *
+ * It is only valid until the next call to Interfaces::update().
+ */
+struct Interface {
+    std::string_view name;
+    unsigned int flags;   /* Flags from SIOCGIFFLAGS */
+    int ifindex;
+
+    const interface_stats &stat;
+
+    const ipv4_addrs ipv4_addrs_v;
+    const ipv6_addrs ipv6_addrs_v;
+
+    const interface_rates &rates;
+    const interface_rates_history &rates_history;
 
-    void reset() noexcept;
+    /**
+     * Whether the interface carries the traffic to the internet
+     */
+    bool is_primary;
+    /**
+     * The default route via this interface, or nullptr if there is none.
+     */
+    const default_route *route;
 };
 
+/**
+ * Interfaces is stored as a table of struct of arrays.
+ *
+ * Each column only grows when there are more interfaces than ever seen, and rows of
+ * interfaces that are gone are moved to the back of the table to be reused later,
+ * so that Interfaces::update() does not allocate once it reaches the steady state.
+ *
+ * The addresses of all interfaces are stored in per-family arenas and each interface
+ * refers to a range of it.
+ */
 class Interfaces {
+public:
+    using name_t = std::array<char, IFNAMSIZ>;
+
+private:
+    /**
+     * Range in ipv4_arena/ipv6_arena
+     */
+    struct addr_range {
+        std::uint32_t begin;
+        std::uint32_t cnt;
+    };
+
+    enum row_state: std::uint8_t {
+        /**
+         * Whether the interface is found in the latest call to Interfaces::update()
+         */
+        present       = 1 << 0,
+        /**
+         * Whether stat is set in the latest call to Interfaces::update()
+         */
+        has_stat      = 1 << 1,
+        /**
+         * Whether prev_stats contains the stat from the previous call to update()
+         */
+        has_prev_stat = 1 << 2,
+    };
+
+    std::size_t rate_window;
+    std::size_t max_interfaces;
+    interfaces_filter filter;
+
+    DefaultRoutes routes;
+
+    /**
+     * Number of rows in use, all columns have at least cnt elements
+     */
     std::size_t cnt = 0;
+
+    std::vector<name_t> names;
+    std::vector<unsigned int> flags;
+    std::vector<int> ifindices;
+    std::vector<std::uint8_t> states;
+    std::vector<interface_stats> stats;
+    std::vector<interface_stats> prev_stats;
+    std::vector<addr_range> ipv4_ranges;
+    std::vector<addr_range> ipv6_ranges;
+    std::vector<interface_rates> rates;
+    std::vector<interface_rates_history> rates_histories;
+
+    /**
+     * timestamp (in ns) of the previous call to update()
+     */
+    std::uint64_t prev_timestamp = 0;
+
+    std::vector<ipv4_addr> ipv4_arena;
+    std::vector<ipv6_addr> ipv6_arena;
+
+    /**
+     * Row index of every entry returned by getifaddrs, reused between updates.
+     */
+    std::vector<std::size_t> entry_rows;
+
+    bool is_interested_entry(const struct ifaddrs *ifa) const noexcept;
     /**
-     * It is unlikely for one computer to have more than 8 network interfaces.
+     * @return index of the row or max_interfaces if the table is full.
      */
-    std::array<Interface, 8> interfaces;
+    auto find_or_add_row(const char *name) -> std::size_t;
+    void swap_rows(std::size_t i, std::size_t j) noexcept;
+    void update_rates(std::size_t i, std::uint64_t elapsed) noexcept;
 
 public:
-    using iterator       = typename std::array<Interface, 8>::iterator;
-    using const_iterator = typename std::array<Interface, 8>::const_iterator;
+    class const_iterator {
+        const Interfaces *interfaces;
+        std::size_t i;
 
-    Interfaces() = default;
+    public:
+        const_iterator(const Interfaces *interfaces, std::size_t i) noexcept;
+
+        auto operator * () const noexcept -> Interface;
+        auto operator ++ () noexcept -> const_iterator&;
+
+        bool operator == (const const_iterator &other) const noexcept;
+        bool operator != (const const_iterator &other) const noexcept;
+    };
+
+    /**
+     * @param rate_window number of samples of rates kept for each interface,
+     *                    must not be 0.
+     * @param max_interfaces maximum number of interfaces to be stored
+     */
+    Interfaces(std::size_t rate_window, std::size_t max_interfaces, interfaces_filter &&filter);
     ~Interfaces() = default;
 
-    auto operator [] (std::string_view name) noexcept -> iterator;
+    /**
+     * Route changes are only picked up after routes.handle_notifications() returns true.
+     */
+    auto get_routes() noexcept -> DefaultRoutes&;
 
     bool is_empty() const noexcept;
     auto size() const noexcept -> std::size_t;
 
-    auto begin() noexcept -> iterator;
-    auto end() noexcept -> iterator;
+    auto operator [] (std::size_t i) const noexcept -> Interface;
 
     auto begin() const noexcept -> const_iterator;
     auto end() const noexcept -> const_iterator;
@@ -97,6 +277,10 @@ public:
     auto cbegin() const noexcept -> const_iterator;
     auto cend() const noexcept -> const_iterator;
 
+    /**
+     * Interfaces that are not present anymore are removed while the rest of them keep their
+     * previous stat, so that the rates can be calculated.
+     */
     void update();
     void clear() noexcept;
 };
@@ -0,0 +1,148 @@
+/**
+ * ABI of native plugins loaded by the block plugin.
+ *
+ * A plugin is a shared library that exports `swaystatus_plugin`, whose abi_version must be
+ * SWAYSTATUS_PLUGIN_ABI_VERSION of the header it is built with.
+ * This header only depends on the C standard library, so that it can be copied into the
+ * source of the plugin.
+ *
+ * SWAYSTATUS_PLUGIN_ABI_VERSION is bumped on any incompatible change, and swaystatus refuses
+ * to load plugins built for another version.
+ */
+#ifndef  __swaystatus_plugin_H__
+# define __swaystatus_plugin_H__
+
+# include <stddef.h>
+# include <stdint.h>
+
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+# define SWAYSTATUS_PLUGIN_ABI_VERSION 1
+
+/**
+ * Same as enum Event in poller.h
+ */
+enum swaystatus_event {
+    swaystatus_read_ready = 1 << 0,
+    swaystatus_pri_ready  = 1 << 1,
+    swaystatus_error      = 1 << 2,
+    swaystatus_hup        = 1 << 3,
+    swaystatus_invalid_fd = -1,
+};
+typedef void (*swaystatus_poller_callback)(int fd, enum swaystatus_event events, void *data);
+
+/**
+ * Functions provided by swaystatus, passed to init.
+ *
+ * Functions taking module must be passed the module passed to init.
+ * Unless stated otherwise, they can only be called on the thread calling the entry points.
+ */
+struct swaystatus_plugin_host {
+    uint32_t abi_version;
+
+    /**
+     * Write str to the output buffer as is, so it must be escaped for a JSON string.
+     * Only callable in render.
+     */
+    void (*print_str2)(const char *str, size_t len);
+    /**
+     * Extend the output buffer by n bytes to be written directly, which must be followed
+     * by commit_print_buffer before anything else is printed.
+     * Only callable in render.
+     */
+    char* (*reserve_print_buffer)(size_t n);
+    /**
+     * Keep the first len bytes written to the area returned by reserve_print_buffer and
+     * escape them in place for a JSON string.
+     */
+    void (*commit_print_buffer)(size_t len);
+
+    /**
+     * Call callback on the main thread once fd is ready for events.
+     */
+    void (*request_polling)(int fd, enum swaystatus_event events,
+                            swaystatus_poller_callback callback, void *data);
+    /**
+     * Stop polling fd, which must be called before fd is closed.
+     */
+    void (*cancel_polling)(int fd);
+    /**
+     * @return a timerfd firing every msec milliseconds, to be passed to request_polling.
+     */
+    int (*create_timer)(uintmax_t msec);
+    /**
+     * @return number of times the timer has fired, which must be called once it is ready.
+     */
+    uint64_t (*read_timer)(int timerfd);
+
+    /**
+     * Make update called in the next tick.
+     */
+    void (*request_update)(void *module);
+    /**
+     * Make update called and all blocks printed as soon as the current round of polling
+     * is done.
+     */
+    void (*request_immediate_update)(void *module);
+    /**
+     * Set "urgent" of the block until it is set to 0.
+     */
+    void (*set_urgent)(void *module, int urgent);
+};
+
+/**
+ * Set if update, render and reload only touch the state of the plugin and never call the
+ * functions of swaystatus_plugin_host other than print_str2, reserve_print_buffer and
+ * commit_print_buffer, so that "blocking" can be set to call them in the worker pool.
+ */
+# define SWAYSTATUS_PLUGIN_UPDATE_OFF_THREAD (1 << 0)
+
+struct swaystatus_plugin {
+    uint32_t abi_version;
+    /**
+     * Bitwise or of SWAYSTATUS_PLUGIN_*
+     */
+    uint32_t flags;
+
+    /**
+     * init, update and render must not be NULL, otherwise the plugin is rejected.
+     *
+     * @param host valid until fini is called.
+     * @param module opaque handle of the block, passed to functions of host.
+     * @param config "config" of the block in JSON, NULL if it is not specified.
+     * @return state passed to the other entry points, NULL on failure.
+     */
+    void* (*init)(const struct swaystatus_plugin_host *host, void *module, const char *config);
+    /**
+     * Called on every update_interval and after request_update.
+     */
+    void (*update)(void *state);
+    /**
+     * Print full_text or short_text with print_str2 or reserve_print_buffer.
+     *
+     * @param format "format" or "short_format" of the block, "" by default.
+     */
+    void (*render)(void *state, const char *format);
+    /**
+     * Called when click_event_handler of the block requests a reload, can be NULL.
+     */
+    void (*reload)(void *state);
+    /**
+     * Called when the block is destroyed, can be NULL.
+     * Reloading swaystatus on SIGUSR1 execs it again without calling fini.
+     */
+    void (*fini)(void *state);
+};
+
+/**
+ * Defined by the plugin.
+ */
+extern const struct swaystatus_plugin swaystatus_plugin;
+
+# ifdef __cplusplus
+}
+# endif
+
+#endif
@@ -14,6 +14,10 @@ struct callback_storer {
 static struct pollfd *fds;
 static nfds_t nfds;
 static struct callback_storer *callbacks;
+/**
+ * Number of entries cancelled but not yet removed from fds.
+ */
+static nfds_t cancelled_cnt;
 
 void init_poller()
 {}
@@ -23,6 +27,8 @@ static short fromEvent(enum Event events)
     short result = 0;
     if (events & read_ready)
         result |= POLLIN;
+    if (events & pri_ready)
+        result |= POLLPRI;
     return result;
 }
 static enum Event toEvent(short events)
@@ -34,6 +40,8 @@ static enum Event toEvent(short events)
 
     if (events & POLLIN)
         result |= read_ready;
+    if (events & POLLPRI)
+        result |= pri_ready;
     if (events & POLLERR)
         result |= error;
     if (events & POLLHUP)
@@ -58,6 +66,35 @@ void request_polling(int fd, enum Event events, poller_callback callback, void *
     };
 }
 
+void cancel_polling(int fd)
+{
+    for (nfds_t i = 0; i != nfds; ++i) {
+        if (fds[i].fd == fd) {
+            /*
+             * Entries are only marked here, since it might be called in perform_polling.
+             * poll ignores negative fd.
+             */
+            fds[i].fd = -1;
+            ++cancelled_cnt;
+            return;
+        }
+    }
+}
+static void remove_cancelled()
+{
+    nfds_t j = 0;
+    for (nfds_t i = 0; i != nfds; ++i) {
+        if (fds[i].fd < 0)
+            continue;
+
+        fds[j] = fds[i];
+        callbacks[j] = callbacks[i];
+        ++j;
+    }
+    nfds = j;
+    cancelled_cnt = 0;
+}
+
 static nfds_t skip_empty_revents(nfds_t i)
 {
     for (; fds[i].revents == 0; ++i)
@@ -67,6 +104,9 @@ static nfds_t skip_empty_revents(nfds_t i)
 
 void perform_polling(int timeout)
 {
+    if (cancelled_cnt != 0)
+        remove_cancelled();
+
     if (nfds == 0)
         return;
 
@@ -82,8 +122,11 @@ void perform_polling(int timeout)
     for (int cnt = 0; cnt != result; ++cnt) {
         i = skip_empty_revents(i);
 
-        struct callback_storer *storer = &callbacks[i];
-        storer->callback(fds[i].fd, toEvent(fds[i].revents), storer->data);
+        /* Skip fds cancelled by callbacks called before in this loop */
+        if (fds[i].fd >= 0) {
+            struct callback_storer *storer = &callbacks[i];
+            storer->callback(fds[i].fd, toEvent(fds[i].revents), storer->data);
+        }
 
         ++i;
     }
@@ -9,6 +9,10 @@ void init_poller();
 
 enum Event {
     read_ready = 1 << 0,
+    /**
+     * Priority data (POLLPRI), e.g. PSI triggers and changes of /proc/self/mountinfo.
+     */
+    pri_ready  = 1 << 1,
     /**
      * error, hup and invalid_fd can be set in event for the poller_callback,
      * no matter it is registed with it or not.
@@ -20,6 +24,12 @@ enum Event {
 typedef void (*poller_callback)(int fd, enum Event events, void *data);
 
 void request_polling(int fd, enum Event events, poller_callback callback, void *data);
+/**
+ * Stop polling fd, it is safe to be called in any poller_callback, including the one of fd.
+ *
+ * fd must be cancelled before it is closed.
+ */
+void cancel_polling(int fd);
 
 void perform_polling(int timeout);
 
@@ -0,0 +1,97 @@
+#include <cstring>
+
+#include "utility.h"
+#include "proc_stat.hpp"
+
+namespace swaystatus {
+auto cpu_times::get_total() const noexcept -> std::uint64_t
+{
+    return user + nice + system + idle + iowait + irq + softirq + steal;
+}
+auto cpu_times::get_busy() const noexcept -> std::uint64_t
+{
+    return get_total() - idle - iowait;
+}
+
+static auto parse_cpu_times(const char *p, cpu_times &times) noexcept -> const char*
+{
+    p = parse_uint(p, &times.user);
+    p = parse_uint(p, &times.nice);
+    p = parse_uint(p, &times.system);
+    p = parse_uint(p, &times.idle);
+    p = parse_uint(p, &times.iowait);
+    p = parse_uint(p, &times.irq);
+    p = parse_uint(p, &times.softirq);
+    p = parse_uint(p, &times.steal);
+    return p;
+}
+
+static bool starts_with(const char *p, const char *end, const char *prefix, std::size_t len) noexcept
+{
+    return static_cast<std::size_t>(end - p) >= len && std::memcmp(p, prefix, len) == 0;
+}
+
+bool parse_proc_stat(const char *buffer, std::size_t len, proc_stat &stat)
+{
+    const char *p = buffer;
+    const char * const end = buffer + len;
+
+    std::size_t core_cnt = 0;
+
+    while (p != end) {
+        if (starts_with(p, end, "cpu", 3)) {
+            p += 3;
+
+            if (*p == ' ') {
+                p = parse_cpu_times(p, stat.total);
+            } else if (is_digit(*p)) {
+                std::uint64_t id;
+                p = parse_uint(p, &id);
+
+                if (UNLIKELY(core_cnt == stat.cores.size())) {
+                    stat.cores.emplace_back();
+                    stat.core_ids.emplace_back();
+                }
+
+                stat.core_ids[core_cnt] = static_cast<std::uint32_t>(id);
+                p = parse_cpu_times(p, stat.cores[core_cnt]);
+                ++core_cnt;
+            } else
+                return false;
+        } else if (starts_with(p, end, "intr ", 5)) {
+            // Only the total is needed, the rest of the line is skipped below
+            p = parse_uint(p + 5, &stat.intr);
+        } else if (starts_with(p, end, "ctxt ", 5)) {
+            p = parse_uint(p + 5, &stat.ctxt);
+        }
+
+        const void *newline = std::memchr(p, '\n', end - p);
+        if (!newline)
+            break;
+        p = static_cast<const char*>(newline) + 1;
+    }
+
+    // cpus might be offlined
+    stat.cores.resize(core_cnt);
+    stat.core_ids.resize(core_cnt);
+
+    return core_cnt != 0 || stat.total.get_total() != 0;
+}
+
+auto get_busy_percentage(const cpu_times &prev, const cpu_times &curr) noexcept -> std::uint8_t
+{
+    const auto prev_total = prev.get_total(), curr_total = curr.get_total();
+    const auto prev_busy = prev.get_busy(), curr_busy = curr.get_busy();
+
+    // Counters can go backwards when a cpu is offlined and onlined again
+    if (curr_total <= prev_total || curr_busy < prev_busy)
+        return 0;
+
+    const auto total = curr_total - prev_total;
+    const auto busy = curr_busy - prev_busy;
+    if (busy >= total)
+        return 100;
+
+    return static_cast<std::uint8_t>((busy * 100 + total / 2) / total);
+}
+} /* namespace swaystatus */
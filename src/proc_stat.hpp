@@ -0,0 +1,75 @@
+#ifndef  __swaystatus_proc_stat_HPP__
+# define __swaystatus_proc_stat_HPP__
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+namespace swaystatus {
+/**
+ * Time spent in each state in USER_HZ, read from the cpu lines of /proc/stat.
+ *
+ * guest and guest_nice are already included in user and nice, so they are not stored.
+ */
+struct cpu_times {
+    std::uint64_t user = 0;
+    std::uint64_t nice = 0;
+    std::uint64_t system = 0;
+    std::uint64_t idle = 0;
+    std::uint64_t iowait = 0;
+    std::uint64_t irq = 0;
+    std::uint64_t softirq = 0;
+    std::uint64_t steal = 0;
+
+    auto get_total() const noexcept -> std::uint64_t;
+    /**
+     * @return total - idle - iowait
+     */
+    auto get_busy() const noexcept -> std::uint64_t;
+};
+
+struct proc_stat {
+    /**
+     * The "cpu" line
+     */
+    cpu_times total;
+    /**
+     * The "cpu<N>" lines, offline cpus do not have a line.
+     */
+    std::vector<cpu_times> cores;
+    /**
+     * N in "cpu<N>" of each element of cores.
+     */
+    std::vector<std::uint32_t> core_ids;
+
+    /**
+     * Total number of interrupts serviced
+     */
+    std::uint64_t intr = 0;
+    /**
+     * Total number of context switches
+     */
+    std::uint64_t ctxt = 0;
+};
+
+/**
+ * Parse content of /proc/stat in one pass.
+ *
+ * Lines that are not needed (e.g. the per-interrupt counters of "intr", which is
+ * usually the longest line) are skipped using memchr.
+ *
+ * cores and core_ids are only reallocated if there are more cpus than ever seen.
+ *
+ * @param buffer must be null-terminated
+ * @param len length of buffer excluding the terminating null byte
+ * @return false if it is malformed.
+ */
+bool parse_proc_stat(const char *buffer, std::size_t len, proc_stat &stat);
+
+/**
+ * @return percentage of busy time of curr since prev in range [0, 100]
+ */
+auto get_busy_percentage(const cpu_times &prev, const cpu_times &curr) noexcept -> std::uint8_t;
+} /* namespace swaystatus */
+
+#endif
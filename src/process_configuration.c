@@ -1,4 +1,5 @@
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
 
@@ -121,24 +122,95 @@ const char* get_short_format(const void *module_config, const char *default_val)
     }
 }
 uint32_t get_update_interval(const void *module_config, const char *name, uint32_t default_val)
+{
+    return get_uint_property(module_config, name, "update_interval", default_val);
+}
+bool get_blocking(const void *module_config, const char *name)
+{
+    return get_bool_property(module_config, name, "blocking", false);
+}
+uint32_t get_uint_property(const void *module_config, const char *name,
+                           const char *property, uint32_t default_val)
 {
     if (!module_config)
         return default_val;
 
     struct json_object *value;
-    if (!json_object_object_get_ex(module_config, "update_interval", &value))
+    if (!json_object_object_get_ex(module_config, property, &value))
         return default_val;
 
     errno = 0;
-    int64_t interval = json_object_get_int64(value);
+    int64_t val = json_object_get_int64(value);
     if (errno != 0)
-        err(1, "%s on %s.%s%s", "json_object_get_uint64", name, "update_interval", " failed");
-    if (interval > UINT32_MAX)
-        errx(1, "%s on %s.%s%s", "Value too large", name, "update_interval", "");
-    if (interval < 0)
-        errx(1, "%s on %s.%s%s", "Negative number is not accepted", name, "update_interval", "");
+        err(1, "%s on %s.%s%s", "json_object_get_uint64", name, property, " failed");
+    if (val > UINT32_MAX)
+        errx(1, "%s on %s.%s%s", "Value too large", name, property, "");
+    if (val < 0)
+        errx(1, "%s on %s.%s%s", "Negative number is not accepted", name, property, "");
 
-    return interval;
+    return val;
+}
+bool get_bool_property(const void *module_config, const char *name,
+                       const char *property, bool default_val)
+{
+    if (!module_config)
+        return default_val;
+
+    struct json_object *value;
+    if (!json_object_object_get_ex(module_config, property, &value))
+        return default_val;
+
+    if (json_object_get_type(value) != json_type_boolean)
+        errx(1, "%s on %s.%s%s", "Expected boolean", name, property, "");
+
+    return json_object_get_boolean(value);
+}
+
+const char** get_property_array(const void *module_config, const char *name,
+                                const char *property)
+{
+    if (!module_config)
+        return NULL;
+
+    struct json_object *value;
+    if (!json_object_object_get_ex(module_config, property, &value))
+        return NULL;
+
+    const char **ret;
+    switch (json_object_get_type(value)) {
+        case json_type_string:
+            ret = malloc_checked(2 * sizeof(const char*));
+            ret[0] = strdup_checked(json_object_get_string(value));
+            ret[1] = NULL;
+            return ret;
+
+        case json_type_array:
+            break;
+
+        default:
+            errx(1, "%s on %s.%s%s", "Expected string or array of strings", name, property, "");
+    }
+
+    size_t n = json_object_array_length(value);
+    ret = malloc_checked((n + 1) * sizeof(const char*));
+    for (size_t i = 0; i != n; ++i) {
+        struct json_object *elem = json_object_array_get_idx(value, i);
+        if (json_object_get_type(elem) != json_type_string)
+            errx(1, "%s on %s.%s%s", "Expected string or array of strings", name, property, "");
+        ret[i] = strdup_checked(json_object_get_string(elem));
+    }
+    ret[n] = NULL;
+
+    return ret;
+}
+void free_property_array(const char **array)
+{
+    if (!array)
+        return;
+
+    for (const char **it = array; *it; ++it)
+        free((void*) *it);
+    free(array);
 }
 
 static int has_seperator(const struct json_object *properties)
@@ -166,6 +238,9 @@ const char* get_user_specified_property_str_impl2(void *module_config, unsigned
     json_object_object_del(module_config, "short_format");
     json_object_object_del(module_config, "update_interval");
     json_object_object_del(module_config, "click_event_handler");
+    json_object_object_del(module_config, "blocking");
+    json_object_object_del(module_config, "deadline");
+    json_object_object_del(module_config, "stale_color");
     for (unsigned i = 0; i != n; ++i) {
         json_object_object_del(module_config, va_arg(args, const char*));
     }
@@ -214,3 +289,8 @@ const void* get_click_event_handler(const void *module_config)
 {
     return get_callable(module_config, "click_event_handler");
 }
+void remove_property(void *module_config, const char *property)
+{
+    if (module_config)
+        json_object_object_del(module_config, property);
+}
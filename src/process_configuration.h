@@ -42,7 +42,7 @@ bool is_block_printer_enabled(const void *config, const char *name);
 void free_config(void *config);
 
 /**
- * The 5 getters below are used in 'modules/\*Printer.cc' only
+ * The getters below are used in 'modules/\*Printer.cc' only
  */
 
 /**
@@ -58,10 +58,47 @@ const char* get_short_format(const void *module_config, const char *default_val)
  * @param module_name used only for printing err msg
  */
 uint32_t get_update_interval(const void *module_config, const char *module_name, uint32_t default_val);
+/**
+ * @param module_name used only for printing err msg
+ * @return value of "blocking", false by default.
+ */
+bool get_blocking(const void *module_config, const char *module_name);
+/**
+ * @param module_name used only for printing err msg
+ * @return default_val if module_config is NULL or property is not present.
+ */
+uint32_t get_uint_property(const void *module_config, const char *module_name,
+                           const char *property, uint32_t default_val);
+/**
+ * @param module_name used only for printing err msg
+ * @return default_val if module_config is NULL or property is not present.
+ */
+bool get_bool_property(const void *module_config, const char *module_name,
+                       const char *property, bool default_val);
+
+/**
+ * @param module_name used only for printing err msg
+ * @param property its value can either be a string or an array of strings
+ * @return heap-allocated NULL-terminated array of heap-allocated strings, or NULL if
+ *         module_config is NULL or property is not present.
+ *         It should be freed by free_property_array.
+ */
+const char** get_property_array(const void *module_config, const char *module_name,
+                                const char *property);
+/**
+ * @param array can be NULL
+ */
+void free_property_array(const char **array);
 
 const void* get_callable(const void *module_config, const char *property_name);
 const void* get_click_event_handler(const void *module_config);
 
+/**
+ * Remove property so that it is not included in get_user_specified_property_str_impl*.
+ * Does nothing if module_config is NULL or property is not present.
+ */
+void remove_property(void *module_config, const char *property);
+
 /**
  * @param n number of variadic args
  * @param args should be properties to be removed before converting this module_config 
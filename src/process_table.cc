@@ -0,0 +1,360 @@
+#ifndef  _GNU_SOURCE
+# define _GNU_SOURCE     /* For getdents64 and memrchr */
+#endif
+
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>         /* For O_RDONLY and O_DIRECTORY */
+#include <unistd.h>        /* For pread, lseek, sysconf */
+#include <dirent.h>        /* For getdents64 */
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+
+#include "utility.h"
+#include "mem_size_t.hpp"
+#include "formatting/fmt_utility.hpp"
+#include "process_table.hpp"
+
+namespace swaystatus {
+
+/**
+ * @return 0 if name is not a pid
+ */
+static auto parse_pid(const char *name) noexcept -> pid_t
+{
+    pid_t pid = 0;
+    for (; *name != '\0'; ++name) {
+        if (!is_digit(*name))
+            return 0;
+        pid = pid * 10 + (*name - '0');
+    }
+    return pid;
+}
+
+/**
+ * Number of stat fds kept open, well below the default soft limit of open files 1024 so that
+ * the rest of swaystatus is not starved of fds.
+ * Stat of processes beyond it is opened on every update instead.
+ */
+static constexpr const std::size_t max_stat_fds = 512;
+
+static auto skip_fields(const char *p, const char *end, std::size_t n) noexcept -> const char*
+{
+    for (; n != 0; --n) {
+        p = static_cast<const char*>(std::memchr(p, ' ', end - p));
+        if (!p)
+            return nullptr;
+        ++p;
+    }
+    return p;
+}
+
+bool parse_pid_stat(const char *buffer, std::size_t len, std::string &comm,
+                    std::uint64_t &cpu_ticks, std::uint64_t &rss_pages)
+{
+    const char * const end = buffer + len;
+
+    // comm can contain any character including ' ' and ')', so search for the last ')'.
+    const char *lparen = static_cast<const char*>(std::memchr(buffer, '(', len));
+    const char *rparen = static_cast<const char*>(memrchr(buffer, ')', len));
+    if (!lparen || !rparen || rparen < lparen || end - rparen < 2)
+        return false;
+
+    comm.assign(lparen + 1, rparen);
+
+    // Fields are 1-indexed in proc(5), the one after comm is field 3 (state).
+    std::uint64_t utime, stime;
+
+    const char *p = skip_fields(rparen + 2, end, 14 - 3);
+    if (!p)
+        return false;
+    p = parse_uint(p, &utime);
+
+    p = skip_fields(p, end, 1);
+    if (!p)
+        return false;
+    p = parse_uint(p, &stime);
+
+    p = skip_fields(p, end, 24 - 15);
+    if (!p)
+        return false;
+    parse_uint(p, &rss_pages);
+
+    cpu_ticks = utime + stime;
+
+    return true;
+}
+
+Process::Process(pid_t pid, Fd &&stat_fd):
+    pid{pid},
+    stat_fd{std::move(stat_fd)}
+{}
+
+PidScanner::PidScanner(const char *proc_path):
+    proc_path{proc_path},
+    proc_fd{openat_checked("", AT_FDCWD, proc_path, O_RDONLY | O_DIRECTORY)}
+{}
+
+auto PidScanner::scan() -> const std::vector<pid_t>&
+{
+    if (lseek(proc_fd.get(), 0, SEEK_SET) == (off_t) -1)
+        err(1, "%s on %s failed", "lseek", proc_path.c_str());
+
+    std::size_t len = 0;
+    for (;;) {
+        // Make sure there is always enough space for at least one entry
+        if (dents_buffer.size() - len < sizeof(struct dirent64) + 256)
+            dents_buffer.resize(dents_buffer.size() * 2);
+
+        ssize_t cnt = getdents64(proc_fd.get(), dents_buffer.data() + len, dents_buffer.size() - len);
+        if (cnt < 0) {
+            if (errno == EINTR)
+                continue;
+            err(1, "%s on %s failed", "getdents64", proc_path.c_str());
+        }
+        if (cnt == 0)
+            break;
+        len += cnt;
+    }
+
+    pids.clear();
+    for (std::size_t off = 0; off < len; ) {
+        const auto *entry = reinterpret_cast<const struct dirent64*>(dents_buffer.data() + off);
+        off += entry->d_reclen;
+
+        if (entry->d_type != DT_DIR && entry->d_type != DT_UNKNOWN)
+            continue;
+
+        pid_t pid = parse_pid(entry->d_name);
+        if (pid != 0)
+            pids.push_back(pid);
+    }
+
+    // procfs already lists pids in ascending order
+    if (!std::is_sorted(pids.begin(), pids.end()))
+        std::sort(pids.begin(), pids.end());
+
+    return pids;
+}
+
+int PidScanner::get_proc_fd() const noexcept
+{
+    return proc_fd.get();
+}
+auto PidScanner::get_proc_path() const noexcept -> const std::string&
+{
+    return proc_path;
+}
+
+int open_pid_file(const PidScanner &scanner, pid_t pid, const char *filename)
+{
+    char path[64];
+    std::snprintf(path, sizeof(path), "%d/%s", static_cast<int>(pid), filename);
+
+    int fd;
+    do {
+        fd = openat(scanner.get_proc_fd(), path, O_RDONLY | O_CLOEXEC);
+    } while (fd == -1 && errno == EINTR);
+
+    if (fd == -1) {
+        switch (errno) {
+            // The process is already dead or hidden by hidepid
+            case ENOENT:
+            case ESRCH:
+            case EACCES:
+            case EMFILE:
+            case ENFILE:
+                break;
+
+            default:
+                err(1, "openat %s/%s failed", scanner.get_proc_path().c_str(), path);
+        }
+    }
+
+    return fd;
+}
+
+bool read_pid_stat(int fd, Process &process, std::uint64_t elapsed)
+{
+    static const auto ticks_per_second = static_cast<std::uint64_t>(sysconf(_SC_CLK_TCK));
+    static const auto page_size = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+
+    char buffer[1024];
+
+    ssize_t cnt;
+    do {
+        cnt = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    } while (cnt < 0 && errno == EINTR);
+
+    // ESRCH: the process exited after its stat was opened.
+    if (cnt <= 0)
+        return false;
+    buffer[cnt] = '\0';
+
+    std::uint64_t cpu_ticks, rss_pages;
+    if (!parse_pid_stat(buffer, cnt, process.comm, cpu_ticks, rss_pages))
+        return false;
+
+    // For processes started after the last update, all of their ticks are spent since then.
+    if (elapsed != 0 && cpu_ticks >= process.cpu_ticks) {
+        process.cpu_usage = static_cast<std::uint32_t>(
+            (cpu_ticks - process.cpu_ticks) * 100 * 1000 * 1000 * 1000 / ticks_per_second / elapsed
+        );
+    } else
+        process.cpu_usage = 0;
+
+    process.cpu_ticks = cpu_ticks;
+    process.rss = rss_pages * page_size;
+
+    return true;
+}
+
+ProcessTable::ProcessTable(std::size_t top_n, process_sort_key sort_key, const char *proc_path):
+    scanner{proc_path},
+    top_n{top_n},
+    sort_key{sort_key}
+{}
+
+auto ProcessTable::open_stat(pid_t pid) -> Fd
+{
+    int fd = open_pid_file(scanner, pid, "stat");
+    if (fd == -1) {
+        if (errno == EMFILE || errno == ENFILE)
+            fd_limit_reached = true;
+        return {};
+    }
+    return {fd};
+}
+
+void ProcessTable::merge_pids(const std::vector<pid_t> &pids)
+{
+    auto &merged = merged_processes;
+    merged.clear();
+
+    // Fds of processes that are dead are still counted, which only makes the budget stricter.
+    auto stat_fd_cnt = static_cast<std::size_t>(std::count_if(
+        processes.begin(), processes.end(), [](const Process &process) noexcept {
+            return static_cast<bool>(process.stat_fd);
+        }));
+
+    auto it = processes.begin(), end = processes.end();
+    for (pid_t pid: pids) {
+        // Processes not listed are dead, they are dropped here.
+        while (it != end && it->pid < pid)
+            ++it;
+
+        if (it != end && it->pid == pid) {
+            merged.push_back(std::move(*it));
+            ++it;
+        } else {
+            // New process, its stat is kept open unless limit of fds is reached.
+            const bool keep_open = !fd_limit_reached && stat_fd_cnt < max_stat_fds;
+            merged.emplace_back(pid, keep_open ? open_stat(pid) : Fd{});
+            stat_fd_cnt += static_cast<bool>(merged.back().stat_fd);
+        }
+    }
+
+    processes.swap(merged);
+}
+
+bool ProcessTable::read_stat(Process &process, std::uint64_t elapsed)
+{
+    if (process.stat_fd)
+        return read_pid_stat(process.stat_fd.get(), process, elapsed);
+
+    int fd = open_pid_file(scanner, process.pid, "stat");
+    if (fd == -1)
+        return false;
+
+    Fd tmp_fd{fd};
+    return read_pid_stat(fd, process, elapsed);
+}
+
+void ProcessTable::select_top()
+{
+    top.clear();
+    for (const auto &process: processes)
+        top.push_back(&process);
+
+    auto cmp = [this](const Process *x, const Process *y) noexcept {
+        if (sort_key == process_sort_key::cpu && x->cpu_usage != y->cpu_usage)
+            return x->cpu_usage > y->cpu_usage;
+        return x->rss > y->rss;
+    };
+
+    const auto n = std::min(top_n, top.size());
+    std::partial_sort(top.begin(), top.begin() + n, top.end(), cmp);
+    top.resize(n);
+}
+
+void ProcessTable::update()
+{
+    const auto now = get_monotonic_timestamp();
+    // On the first update, every process looks new and would have all its ticks counted.
+    const auto elapsed = timestamp == 0 ? 0 : now - timestamp;
+    timestamp = now;
+
+    merge_pids(scanner.scan());
+
+    auto dead = std::remove_if(processes.begin(), processes.end(), [&](Process &process) {
+        return !read_stat(process, elapsed);
+    });
+    processes.erase(dead, processes.end());
+
+    select_top();
+}
+
+auto ProcessTable::get_process_count() const noexcept -> std::size_t
+{
+    return processes.size();
+}
+auto ProcessTable::get_top() const noexcept -> const std::vector<const Process*>&
+{
+    return top;
+}
+} /* namespace swaystatus */
+
+using Processes_formatter = fmt::formatter<std::vector<const swaystatus::Process*>>;
+
+auto Processes_formatter::parse(format_parse_context &ctx) -> format_parse_context_it
+{
+    auto it = ctx.begin(), end = ctx.end();
+    if (it == end)
+        return it;
+
+    end = swaystatus::find_end_of_format(ctx);
+
+    fmt_str = std::string_view{it, static_cast<std::size_t>(end - it)};
+
+    return end;
+}
+auto Processes_formatter::format(const Processes &processes, format_context &ctx)
+    -> format_context_it
+{
+    auto out = ctx.out();
+
+    if (fmt_str.size() == 0)
+        return out;
+
+    std::size_t i = 0;
+    for (const auto *process: processes) {
+        out = format_to(
+            out,
+            fmt_str,
+            fmt::arg("pid",       process->pid),
+            fmt::arg("comm",      process->comm),
+            fmt::arg("cpu_usage", process->cpu_usage),
+            fmt::arg("rss",       swaystatus::mem_size_t{process->rss})
+        );
+
+        if (++i != processes.size()) {
+            *out = ' ';
+            ++out;
+        }
+    }
+
+    return out;
+}
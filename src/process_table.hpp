@@ -0,0 +1,191 @@
+#ifndef  __swaystatus_process_table_HPP__
+# define __swaystatus_process_table_HPP__
+
+# include <sys/types.h>
+
+# include <cstddef>
+# include <cstdint>
+# include <string>
+# include <string_view>
+# include <vector>
+
+# include "Fd.hpp"
+
+# include "formatting/fmt_config.hpp"
+# include "formatting/fmt/include/fmt/format.h"
+
+namespace swaystatus {
+struct Process {
+    pid_t pid;
+
+    /**
+     * Persistent fd of /proc/<pid>/stat, which also contains rss, so statm is not needed.
+     *
+     * Empty if it cannot be kept open due to the budget or limit of fds, then stat is opened
+     * on every update instead.
+     */
+    Fd stat_fd;
+
+    std::string comm;
+
+    /**
+     * utime + stime in clock ticks
+     */
+    std::uint64_t cpu_ticks = 0;
+    /**
+     * In bytes
+     */
+    std::uint64_t rss = 0;
+    /**
+     * Percentage of one cpu used since the last update, can exceed 100 for
+     * multi-threaded processes.
+     */
+    std::uint32_t cpu_usage = 0;
+
+    Process(pid_t pid, Fd &&stat_fd);
+};
+
+/**
+ * PidScanner lists pids in /proc using getdents64 on a persistent fd into a single buffer.
+ */
+class PidScanner {
+    std::string proc_path;
+    Fd proc_fd;
+
+    /**
+     * Buffer for getdents64, it only grows when /proc has more entries than ever seen.
+     */
+    std::vector<char> dents_buffer = std::vector<char>(32 * 1024);
+    std::vector<pid_t> pids;
+
+public:
+    /**
+     * @param proc_path path to procfs, can be changed for testing
+     */
+    PidScanner(const char *proc_path);
+
+    PidScanner(PidScanner&&) = default;
+    PidScanner& operator = (PidScanner&&) = default;
+
+    ~PidScanner() = default;
+
+    /**
+     * @return sorted pids, valid until the next call to scan().
+     */
+    auto scan() -> const std::vector<pid_t>&;
+
+    int get_proc_fd() const noexcept;
+    auto get_proc_path() const noexcept -> const std::string&;
+};
+
+/**
+ * Open /proc/<pid>/<filename>
+ *
+ * @return -1 if the process is dead (ENOENT/ESRCH), hidden (EACCES) or the limit of fds is
+ *         reached (EMFILE/ENFILE), errno is kept. Fails on other errors.
+ */
+int open_pid_file(const PidScanner &scanner, pid_t pid, const char *filename);
+
+/**
+ * Read /proc/<pid>/stat through fd and update comm, cpu_ticks, rss and cpu_usage of process.
+ *
+ * @param elapsed in ns since the last read, 0 for the first read
+ * @return false if the process is dead.
+ */
+bool read_pid_stat(int fd, Process &process, std::uint64_t elapsed);
+
+enum class process_sort_key: std::uint8_t {
+    cpu,
+    memory,
+};
+
+/**
+ * ProcessTable keeps a pid-sorted table of all processes with persistent fds to their stat,
+ * up to a fixed budget of fds.
+ *
+ * On each update, pids are discovered by getdents64 on a persistent fd of /proc into a single
+ * buffer and merged with the table, so only new processes are opened.
+ * Processes whose stat returns ESRCH are dropped.
+ */
+class ProcessTable {
+    PidScanner scanner;
+
+    /**
+     * Sorted by pid
+     */
+    std::vector<Process> processes;
+    /**
+     * Swapped with processes in merge_pids() to avoid reallocation.
+     */
+    std::vector<Process> merged_processes;
+
+    std::vector<const Process*> top;
+    std::size_t top_n;
+    process_sort_key sort_key;
+
+    std::uint64_t timestamp = 0;
+
+    /**
+     * Set once openat fails with EMFILE/ENFILE, after which stat of new processes are no longer
+     * kept open.
+     */
+    bool fd_limit_reached = false;
+
+    void merge_pids(const std::vector<pid_t> &pids);
+    auto open_stat(pid_t pid) -> Fd;
+    /**
+     * @return false if the process is dead.
+     */
+    bool read_stat(Process &process, std::uint64_t elapsed);
+    void select_top();
+
+public:
+    using const_iterator = typename std::vector<const Process*>::const_iterator;
+
+    /**
+     * @param top_n number of processes in top, must not be 0
+     * @param proc_path path to procfs, can be changed for testing
+     */
+    ProcessTable(std::size_t top_n, process_sort_key sort_key, const char *proc_path = "/proc");
+
+    ProcessTable(ProcessTable&&) = default;
+    ProcessTable& operator = (ProcessTable&&) = default;
+
+    ~ProcessTable() = default;
+
+    void update();
+
+    auto get_process_count() const noexcept -> std::size_t;
+
+    /**
+     * @return top processes sorted by sort_key in descending order
+     */
+    auto get_top() const noexcept -> const std::vector<const Process*>&;
+};
+
+/**
+ * Parse content of /proc/<pid>/stat.
+ *
+ * @param buffer must be null-terminated
+ * @param rss_pages resident set size in pages
+ * @return false if it is malformed.
+ */
+bool parse_pid_stat(const char *buffer, std::size_t len, std::string &comm,
+                    std::uint64_t &cpu_ticks, std::uint64_t &rss_pages);
+} /* namespace swaystatus */
+
+template <>
+struct fmt::formatter<std::vector<const swaystatus::Process*>>
+{
+    using Processes = std::vector<const swaystatus::Process*>;
+
+    using format_parse_context_it = typename format_parse_context::iterator;
+    using format_context_it = typename format_context::iterator;
+
+    std::string_view fmt_str = "";
+
+    auto parse(format_parse_context &ctx) -> format_parse_context_it;
+    auto format(const Processes &processes, format_context &ctx) -> format_context_it;
+};
+
+#endif
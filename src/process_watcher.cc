@@ -0,0 +1,158 @@
+#include <err.h>
+#include <errno.h>
+#include <unistd.h>        /* For syscall */
+#include <sys/syscall.h>   /* For SYS_pidfd_open */
+
+#include <algorithm>
+#include <utility>
+
+#include "utility.h"
+#include "process_watcher.hpp"
+
+namespace swaystatus {
+/**
+ * @return -1 if the process is dead or pidfd_open is not supported.
+ */
+static int pidfd_open_checked(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+    int fd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+    if (fd < 0 && errno != ESRCH && errno != ENOSYS)
+        err(1, "%s on %d failed", "pidfd_open", static_cast<int>(pid));
+    return fd;
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+ProcessWatcher::ProcessWatcher(NameFilter &&filter, std::uint32_t rescan_interval,
+                               poller_callback on_exit, void *on_exit_data,
+                               const char *proc_path):
+    scanner{proc_path},
+    filter{std::move(filter)},
+    on_exit{on_exit},
+    on_exit_data{on_exit_data},
+    rescan_interval{static_cast<std::uint64_t>(rescan_interval) * 1000 * 1000 * 1000}
+{}
+
+ProcessWatcher::~ProcessWatcher()
+{
+    for (const auto &pidfd: pidfds) {
+        if (pidfd)
+            cancel_polling(pidfd.get());
+    }
+}
+
+void ProcessWatcher::watch(pid_t pid)
+{
+    int stat_fd = open_pid_file(scanner, pid, "stat");
+    if (stat_fd == -1)
+        return;
+
+    Process process{pid, Fd{stat_fd}};
+    if (!read_pid_stat(stat_fd, process, 0) || !filter.matches(process.comm.c_str()))
+        return;
+
+    Fd pidfd;
+    int fd = pidfd_open_checked(pid);
+    if (fd != -1) {
+        pidfd = fd;
+
+        // stat_fd refers to the process examined, so if it is still readable, pid is not reused
+        // by another process before pidfd_open.
+        if (!read_pid_stat(stat_fd, process, 0))
+            return;
+
+        request_polling(fd, read_ready, on_exit, on_exit_data);
+    } else if (errno == ESRCH)
+        return;
+
+    processes.push_back(std::move(process));
+    pidfds.push_back(std::move(pidfd));
+}
+void ProcessWatcher::unwatch(std::size_t i)
+{
+    if (pidfds[i])
+        cancel_polling(pidfds[i].get());
+
+    processes.erase(processes.begin() + i);
+    pidfds.erase(pidfds.begin() + i);
+}
+
+void ProcessWatcher::rescan()
+{
+    const auto &pids = scanner.scan();
+
+    // Both pids and seen_pids are sorted, so new pids can be found in one pass.
+    auto it = seen_pids.begin(), end = seen_pids.end();
+    for (pid_t pid: pids) {
+        while (it != end && *it < pid)
+            ++it;
+
+        if (it != end && *it == pid)
+            continue;
+
+        auto watched = std::find_if(processes.begin(), processes.end(), [pid](const auto &process) {
+            return process.pid == pid;
+        });
+        if (watched == processes.end())
+            watch(pid);
+    }
+
+    seen_pids.assign(pids.begin(), pids.end());
+}
+
+void ProcessWatcher::update_view()
+{
+    view.clear();
+    for (const auto &process: processes)
+        view.push_back(&process);
+}
+
+void ProcessWatcher::handle_exit(int pidfd)
+{
+    for (std::size_t i = 0; i != pidfds.size(); ++i) {
+        if (pidfds[i] && pidfds[i].get() == pidfd) {
+            unwatch(i);
+            break;
+        }
+    }
+    rescan_requested = true;
+
+    update_view();
+}
+
+void ProcessWatcher::update()
+{
+    const auto now = get_monotonic_timestamp();
+    const auto elapsed = timestamp == 0 ? 0 : now - timestamp;
+    timestamp = now;
+
+    if (now - last_scan >= rescan_interval) {
+        // A process seen before might have exec'd into a matching one since then.
+        seen_pids.clear();
+        rescan_requested = true;
+    }
+    if (rescan_requested) {
+        rescan_requested = false;
+        last_scan = now;
+        rescan();
+    }
+
+    // Processes not watched by pidfd are dropped here once they exit.
+    for (std::size_t i = 0; i != processes.size(); ) {
+        if (read_pid_stat(processes[i].stat_fd.get(), processes[i], elapsed))
+            ++i;
+        else
+            unwatch(i);
+    }
+
+    update_view();
+}
+
+auto ProcessWatcher::get_processes() const noexcept -> const std::vector<const Process*>&
+{
+    return view;
+}
+} /* namespace swaystatus */
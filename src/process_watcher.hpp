@@ -0,0 +1,83 @@
+#ifndef  __swaystatus_process_watcher_HPP__
+# define __swaystatus_process_watcher_HPP__
+
+# include <cstddef>
+# include <cstdint>
+# include <vector>
+
+# include "Fd.hpp"
+# include "NameFilter.hpp"
+# include "poller.h"
+# include "process_table.hpp"
+
+namespace swaystatus {
+/**
+ * ProcessWatcher tracks processes whose comm matches filter.
+ *
+ * Each of them is held by a pidfd registered with the poller, so its exit is noticed as soon
+ * as the pidfd becomes readable.
+ *
+ * /proc is only scanned again on rescan_interval or after a watched process exits.
+ * The latter only examines pids not seen in the last scan, while the former examines all of
+ * them to catch processes that exec'd into a matching one.
+ */
+class ProcessWatcher {
+    PidScanner scanner;
+    NameFilter filter;
+
+    poller_callback on_exit;
+    void *on_exit_data;
+
+    std::uint64_t rescan_interval;
+    std::uint64_t last_scan = 0;
+    bool rescan_requested = true;
+
+    /**
+     * Sorted pids seen in the last scan
+     */
+    std::vector<pid_t> seen_pids;
+
+    std::vector<Process> processes;
+    /**
+     * Indexed the same as processes, empty if pidfd_open is not supported.
+     */
+    std::vector<Fd> pidfds;
+    std::vector<const Process*> view;
+
+    std::uint64_t timestamp = 0;
+
+    void rescan();
+    void watch(pid_t pid);
+    void unwatch(std::size_t i);
+    void update_view();
+
+public:
+    /**
+     * @param rescan_interval in seconds
+     * @param on_exit registered with the poller for every pidfd, it should call handle_exit.
+     * @param proc_path path to procfs, can be changed for testing
+     */
+    ProcessWatcher(NameFilter &&filter, std::uint32_t rescan_interval,
+                   poller_callback on_exit, void *on_exit_data,
+                   const char *proc_path = "/proc");
+
+    ProcessWatcher(const ProcessWatcher&) = delete;
+    ProcessWatcher& operator = (const ProcessWatcher&) = delete;
+
+    ~ProcessWatcher();
+
+    /**
+     * Stop watching the process of pidfd and rescan /proc on next update.
+     */
+    void handle_exit(int pidfd);
+
+    void update();
+
+    /**
+     * @return processes watched, valid until the next call to update() or handle_exit().
+     */
+    auto get_processes() const noexcept -> const std::vector<const Process*>&;
+};
+} /* namespace swaystatus */
+
+#endif
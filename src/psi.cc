@@ -0,0 +1,85 @@
+#include <err.h>
+#include <errno.h>
+
+#include <unistd.h> /* For pread */
+
+#include <cstdlib>
+#include <cstring>
+
+#include "utility.h"
+#include "psi.hpp"
+
+namespace swaystatus {
+/**
+ * Parse "1.23" as 123
+ */
+static auto parse_avg(const char *str) noexcept -> psi_avg
+{
+    char *endptr;
+    auto val = static_cast<std::uint32_t>(std::strtoul(str, &endptr, 10)) * 100;
+    // The kernel always prints exactly two digits after the decimal point
+    if (endptr[0] == '.' && is_digit(endptr[1]) && is_digit(endptr[2]))
+        val += (endptr[1] - '0') * 10 + (endptr[2] - '0');
+    return {val};
+}
+static void parse_line(const char *line, psi_line &result) noexcept
+{
+    auto get_field = [line](const char *name) noexcept -> const char* {
+        const char *field = std::strstr(line, name);
+        return field ? field + std::strlen(name) : nullptr;
+    };
+
+    if (auto *field = get_field(" avg10="))
+        result.avg10 = parse_avg(field);
+    if (auto *field = get_field(" avg60="))
+        result.avg60 = parse_avg(field);
+    if (auto *field = get_field(" avg300="))
+        result.avg300 = parse_avg(field);
+    if (auto *field = get_field(" total="))
+        result.total = std::strtoull(field, nullptr, 10);
+}
+
+void parse_psi(char *buffer, psi_stats &stats) noexcept
+{
+    char *line = buffer;
+    while (line && *line != '\0') {
+        char *newline = std::strchr(line, '\n');
+        if (newline)
+            *newline = '\0';
+
+        if (std::strncmp(line, "some ", 5) == 0)
+            parse_line(line + 4, stats.some);
+        else if (std::strncmp(line, "full ", 5) == 0)
+            parse_line(line + 4, stats.full);
+
+        line = newline ? newline + 1 : nullptr;
+    }
+}
+
+void read_psi(int fd, const char *path, psi_stats &stats)
+{
+    // Each line is at most 80 bytes
+    char buffer[256];
+
+    ssize_t cnt;
+    do {
+        cnt = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    } while (cnt < 0 && errno == EINTR);
+    if (cnt < 0)
+        err(1, "%s on %s failed", "pread", path);
+    buffer[cnt] = '\0';
+
+    parse_psi(buffer, stats);
+}
+} /* namespace swaystatus */
+
+using psi_avg_formatter = fmt::formatter<swaystatus::psi_avg>;
+
+auto psi_avg_formatter::parse(format_parse_context &ctx) -> format_parse_context_it
+{
+    return ctx.begin();
+}
+auto psi_avg_formatter::format(const psi_avg &avg, format_context &ctx) -> format_context_it
+{
+    return fmt::format_to(ctx.out(), "{}.{:02}", avg.val / 100, avg.val % 100);
+}
@@ -0,0 +1,66 @@
+#ifndef  __swaystatus_psi_HPP__
+# define __swaystatus_psi_HPP__
+
+# include <cstdint>
+
+# include "formatting/fmt_config.hpp"
+# include "formatting/fmt/include/fmt/format.h"
+
+namespace swaystatus {
+/**
+ * Average of pressure stall information in hundredths of percent, e.g. 123 for "1.23"
+ */
+struct psi_avg {
+    std::uint32_t val = 0;
+};
+
+struct psi_line {
+    psi_avg avg10;
+    psi_avg avg60;
+    psi_avg avg300;
+    /**
+     * Total stall time in us
+     */
+    std::uint64_t total = 0;
+};
+
+/**
+ * Content of /proc/pressure/{cpu,memory,io} or {cpu,memory,io}.pressure of a cgroup.
+ */
+struct psi_stats {
+    psi_line some;
+    /**
+     * Always 0 for cpu on kernels older than 5.13
+     */
+    psi_line full;
+};
+
+/**
+ * @param buffer must be null-terminated, newlines in it are replaced with null bytes.
+ */
+void parse_psi(char *buffer, psi_stats &stats) noexcept;
+
+/**
+ * Read and parse the pressure file at fd using pread.
+ *
+ * @param path used only for printing err msg
+ */
+void read_psi(int fd, const char *path, psi_stats &stats);
+} /* namespace swaystatus */
+
+/**
+ * Formatted as "1.23"
+ */
+template <>
+struct fmt::formatter<swaystatus::psi_avg>
+{
+    using psi_avg = swaystatus::psi_avg;
+
+    using format_parse_context_it = typename format_parse_context::iterator;
+    using format_context_it = typename format_context::iterator;
+
+    auto parse(format_parse_context &ctx) -> format_parse_context_it;
+    auto format(const psi_avg &avg, format_context &ctx) -> format_context_it;
+};
+
+#endif
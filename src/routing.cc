@@ -0,0 +1,429 @@
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include <err.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "routing.hpp"
+
+namespace swaystatus {
+/**
+ * Large enough for one multipart message of a route dump
+ */
+static constexpr const std::size_t buffer_size = 16 * 1024;
+
+static int open_netlink_socket(int flags, std::uint32_t groups)
+{
+    int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | flags, NETLINK_ROUTE);
+    if (fd < 0)
+        err(1, "%s failed", "socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE)");
+
+    struct sockaddr_nl addr = {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = groups;
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0)
+        err(1, "%s failed", "bind on netlink socket");
+
+    return fd;
+}
+
+/**
+ * Fixed addresses on the internet the primary interface is resolved with.
+ * No packet is sent to them.
+ */
+static const struct in_addr probe_ipv4 = {htonl(0x08080808)}; /* 8.8.8.8 */
+static const struct in6_addr probe_ipv6 = {{{
+    0x20, 0x01, 0x48, 0x60, 0x48, 0x60, 0, 0, 0, 0, 0, 0, 0, 0, 0x88, 0x88
+}}}; /* 2001:4860:4860::8888 */
+
+static auto get_probe(int family) noexcept -> const void*
+{
+    return family == AF_INET ? static_cast<const void*>(&probe_ipv4) : &probe_ipv6;
+}
+static auto get_addr_len(int family) noexcept -> std::size_t
+{
+    return family == AF_INET ? sizeof(probe_ipv4) : sizeof(probe_ipv6);
+}
+
+static int open_notification_socket()
+{
+    int fd = open_netlink_socket(SOCK_NONBLOCK, RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE);
+
+    // wg-quick adds its policy rules after the route in its own table.
+    for (int group: {RTNLGRP_IPV4_RULE, RTNLGRP_IPV6_RULE}) {
+        if (setsockopt(fd, SOL_NETLINK, NETLINK_ADD_MEMBERSHIP, &group, sizeof(group)) < 0)
+            err(1, "%s failed", "setsockopt NETLINK_ADD_MEMBERSHIP");
+    }
+
+    return fd;
+}
+
+DefaultRoutes::DefaultRoutes():
+    notification_fd{open_notification_socket()},
+    query_fd{open_netlink_socket(0, 0)},
+    buffer{new char[buffer_size]}
+{}
+
+int DefaultRoutes::get_notification_fd() const noexcept
+{
+    return notification_fd.get();
+}
+
+static auto get_table(const struct rtmsg *rtm, std::size_t len) noexcept -> std::uint32_t
+{
+    std::uint32_t table = rtm->rtm_table;
+    for (auto *rta = RTM_RTA(rtm); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type == RTA_TABLE)
+            std::memcpy(&table, RTA_DATA(rta), sizeof(table));
+    }
+    return table;
+}
+
+static bool is_default_route(const struct rtmsg *rtm, std::size_t len) noexcept
+{
+    if (rtm->rtm_dst_len != 0 || rtm->rtm_type != RTN_UNICAST)
+        return false;
+    if (rtm->rtm_family != AF_INET && rtm->rtm_family != AF_INET6)
+        return false;
+
+    return get_table(rtm, len) == RT_TABLE_MAIN;
+}
+
+/**
+ * @return true if the route, in any table, covers the probe address of its family, thus
+ *         might change the primary interface.
+ */
+static bool is_route_to_probe(const struct rtmsg *rtm, std::size_t len) noexcept
+{
+    if (rtm->rtm_family != AF_INET && rtm->rtm_family != AF_INET6)
+        return false;
+
+    const auto *probe = static_cast<const std::uint8_t*>(get_probe(rtm->rtm_family));
+    const std::size_t addr_len = get_addr_len(rtm->rtm_family);
+
+    if (rtm->rtm_dst_len > addr_len * 8)
+        return false;
+
+    for (auto *rta = RTM_RTA(rtm); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        if (rta->rta_type != RTA_DST || RTA_PAYLOAD(rta) < addr_len)
+            continue;
+
+        const auto *dst = static_cast<const std::uint8_t*>(RTA_DATA(rta));
+        std::size_t bits = rtm->rtm_dst_len;
+        for (std::size_t i = 0; bits != 0; ++i) {
+            std::size_t n = bits < 8 ? bits : 8;
+            std::uint8_t mask = static_cast<std::uint8_t>(0xff00 >> n);
+            if ((dst[i] & mask) != (probe[i] & mask))
+                return false;
+            bits -= n;
+        }
+    }
+
+    // A route without RTA_DST is 0/0
+    return true;
+}
+
+bool DefaultRoutes::handle_notifications() noexcept
+{
+    bool changed = false;
+
+    for (;;) {
+        ssize_t cnt = recv(notification_fd.get(), buffer.get(), buffer_size, MSG_DONTWAIT);
+        if (cnt < 0) {
+            if (errno == EINTR)
+                continue;
+            /*
+             * ENOBUFS means that notifications are dropped by the kernel,
+             * the only thing left to do is to dump the table again.
+             */
+            if (errno == ENOBUFS)
+                changed = true;
+            break;
+        }
+
+        std::size_t len = cnt;
+        for (auto *nlh = reinterpret_cast<struct nlmsghdr*>(buffer.get());
+             NLMSG_OK(nlh, len);
+             nlh = NLMSG_NEXT(nlh, len))
+        {
+            switch (nlh->nlmsg_type) {
+                case RTM_NEWRULE:
+                case RTM_DELRULE:
+                    changed = true;
+                    break;
+
+                case RTM_NEWROUTE:
+                case RTM_DELROUTE: {
+                    auto *rtm = static_cast<const struct rtmsg*>(NLMSG_DATA(nlh));
+                    if (is_route_to_probe(rtm, RTM_PAYLOAD(nlh)))
+                        changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (changed)
+        is_stale = true;
+    return changed;
+}
+
+/**
+ * Parse oif, metric and gateway of the route.
+ */
+static void parse_route(const struct rtmsg *rtm, std::size_t len, default_route &route) noexcept
+{
+    auto parse_gateway = [&route, family = rtm->rtm_family](const struct rtattr *rta) noexcept {
+        route.gateway.family = family;
+        if (family == AF_INET)
+            std::memcpy(&route.gateway.ipv4, RTA_DATA(rta), sizeof(route.gateway.ipv4));
+        else
+            std::memcpy(&route.gateway.ipv6, RTA_DATA(rta), sizeof(route.gateway.ipv6));
+    };
+
+    for (auto *rta = RTM_RTA(rtm); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+        switch (rta->rta_type) {
+            case RTA_OIF:
+                std::memcpy(&route.ifindex, RTA_DATA(rta), sizeof(route.ifindex));
+                break;
+
+            case RTA_PRIORITY:
+                std::memcpy(&route.metric, RTA_DATA(rta), sizeof(route.metric));
+                break;
+
+            case RTA_GATEWAY:
+                parse_gateway(rta);
+                break;
+
+            case RTA_MULTIPATH: {
+                // Only the first nexthop is used
+                auto *rtnh = static_cast<const struct rtnexthop*>(RTA_DATA(rta));
+                if (RTA_PAYLOAD(rta) < sizeof(*rtnh) || rtnh->rtnh_len < sizeof(*rtnh))
+                    break;
+
+                route.ifindex = rtnh->rtnh_ifindex;
+
+                std::size_t nh_len = rtnh->rtnh_len - sizeof(*rtnh);
+                for (auto *nh_rta = RTNH_DATA(rtnh); RTA_OK(nh_rta, nh_len);
+                     nh_rta = RTA_NEXT(nh_rta, nh_len))
+                {
+                    if (nh_rta->rta_type == RTA_GATEWAY)
+                        parse_gateway(nh_rta);
+                }
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Keep the route with the lowest metric of every interface.
+ */
+static void add_route(std::vector<default_route> &routes, const default_route &route)
+{
+    if (route.ifindex == 0)
+        return;
+
+    for (auto &each: routes) {
+        if (each.ifindex == route.ifindex) {
+            if (route.metric < each.metric)
+                each = route;
+            return;
+        }
+    }
+    routes.push_back(route);
+}
+
+template <class F>
+int DefaultRoutes::request(struct nlmsghdr &req, bool is_dump, F &&on_route)
+{
+    req.nlmsg_seq = ++seq;
+
+    const int fd = query_fd.get();
+
+    // Discard replies of previous request that is interrupted
+    while (recv(fd, buffer.get(), buffer_size, MSG_DONTWAIT) > 0)
+        ;
+
+    ssize_t result;
+    do {
+        result = send(fd, &req, req.nlmsg_len, 0);
+    } while (result < 0 && errno == EINTR);
+    if (result < 0)
+        return errno;
+
+    for (;;) {
+        ssize_t cnt = recv(fd, buffer.get(), buffer_size, 0);
+        if (cnt < 0) {
+            if (errno == EINTR)
+                continue;
+            return errno;
+        }
+
+        std::size_t len = cnt;
+        for (auto *nlh = reinterpret_cast<struct nlmsghdr*>(buffer.get());
+             NLMSG_OK(nlh, len);
+             nlh = NLMSG_NEXT(nlh, len))
+        {
+            if (nlh->nlmsg_seq != seq)
+                continue;
+
+            switch (nlh->nlmsg_type) {
+                case NLMSG_DONE:
+                    return 0;
+
+                case NLMSG_ERROR:
+                    return -static_cast<const struct nlmsgerr*>(NLMSG_DATA(nlh))->error;
+
+                case RTM_NEWROUTE:
+                    on_route(static_cast<const struct rtmsg*>(NLMSG_DATA(nlh)), RTM_PAYLOAD(nlh));
+                    // Only one route is replied to a request without NLM_F_DUMP.
+                    if (!is_dump)
+                        return 0;
+                    break;
+            }
+        }
+    }
+}
+
+bool DefaultRoutes::dump()
+{
+    struct {
+        struct nlmsghdr nlh;
+        struct rtmsg rtm;
+    } req = {};
+
+    req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(req.rtm));
+    req.nlh.nlmsg_type = RTM_GETROUTE;
+    req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.rtm.rtm_family = AF_UNSPEC;
+
+    std::vector<default_route> new_routes;
+
+    int error = request(req.nlh, true, [&](const struct rtmsg *rtm, std::size_t len)
+    {
+        if (!is_default_route(rtm, len))
+            return;
+
+        default_route route = {};
+        parse_route(rtm, len, route);
+        add_route(new_routes, route);
+    });
+    if (error != 0) {
+        errno = error;
+        warn("%s failed", "Dumping routes with RTM_GETROUTE");
+        return false;
+    }
+
+    routes = std::move(new_routes);
+    return true;
+}
+
+bool DefaultRoutes::lookup_primary(int family, int &ifindex)
+{
+    struct {
+        struct nlmsghdr nlh;
+        struct rtmsg rtm;
+        char attrs[RTA_SPACE(sizeof(struct in6_addr))];
+    } req = {};
+
+    const std::size_t addr_len = get_addr_len(family);
+
+    req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(req.rtm) + RTA_LENGTH(addr_len));
+    req.nlh.nlmsg_type = RTM_GETROUTE;
+    req.nlh.nlmsg_flags = NLM_F_REQUEST;
+    req.rtm.rtm_family = family;
+    req.rtm.rtm_dst_len = addr_len * 8;
+
+    auto *rta = RTM_RTA(&req.rtm);
+    rta->rta_type = RTA_DST;
+    rta->rta_len = RTA_LENGTH(addr_len);
+    std::memcpy(RTA_DATA(rta), get_probe(family), addr_len);
+
+    default_route route = {};
+
+    int error = request(req.nlh, false, [&](const struct rtmsg *rtm, std::size_t len)
+    {
+        if (rtm->rtm_type == RTN_UNICAST)
+            parse_route(rtm, len, route);
+    });
+    if (error == ENETUNREACH || error == EHOSTUNREACH) {
+        ifindex = 0;
+        return true;
+    }
+    if (error != 0) {
+        errno = error;
+        warn("%s failed", "Looking up route with RTM_GETROUTE");
+        return false;
+    }
+
+    ifindex = route.ifindex;
+    // e.g. the default route of wg-quick is in a table of its own
+    if (find(route.ifindex) == nullptr)
+        add_route(routes, route);
+
+    return true;
+}
+
+void DefaultRoutes::update()
+{
+    if (!is_stale)
+        return;
+
+    if (!dump())
+        return;
+
+    int ifindex = 0;
+    if (!lookup_primary(AF_INET, ifindex))
+        return;
+    if (ifindex == 0 && !lookup_primary(AF_INET6, ifindex))
+        return;
+
+    is_stale = false;
+
+    primary_ifindex = 0;
+    primary_name[0] = '\0';
+    if (ifindex != 0 && if_indextoname(ifindex, primary_name.data()))
+        primary_ifindex = ifindex;
+}
+
+auto DefaultRoutes::find(int ifindex) const noexcept -> const default_route*
+{
+    for (auto &route: routes) {
+        if (route.ifindex == ifindex)
+            return &route;
+    }
+    return nullptr;
+}
+
+int DefaultRoutes::get_primary_ifindex() const noexcept
+{
+    return primary_ifindex;
+}
+auto DefaultRoutes::get_primary_name() const noexcept -> const char*
+{
+    return primary_name.data();
+}
+} /* namespace swaystatus */
+
+using gateway_addr_formatter = fmt::formatter<swaystatus::gateway_addr>;
+
+auto gateway_addr_formatter::format(const gateway_addr &gateway, format_context &ctx) ->
+    format_context_it
+{
+    char buffer[INET6_ADDRSTRLEN] = "";
+
+    if (gateway.family != 0) {
+        FMT_ASSERT(
+            inet_ntop(gateway.family, &gateway.ipv4, buffer, sizeof(buffer)) != nullptr,
+            std::strerror(errno)
+        );
+    }
+
+    return fmt::formatter<const char*>::format(buffer, ctx);
+}
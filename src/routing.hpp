@@ -0,0 +1,142 @@
+#ifndef  __swaystatus_routing_HPP__
+# define __swaystatus_routing_HPP__
+
+# include "formatting/fmt_config.hpp"
+
+# include <netinet/in.h>
+# include <net/if.h>
+
+# include <cstddef>
+# include <cstdint>
+# include <array>
+# include <memory>
+# include <vector>
+
+# include "Fd.hpp"
+
+# include "formatting/fmt/include/fmt/format.h"
+
+namespace swaystatus {
+/**
+ * family is 0 if there is no gateway.
+ */
+struct gateway_addr {
+    std::uint8_t family = 0;
+    union {
+        struct in_addr ipv4;
+        struct in6_addr ipv6;
+    };
+};
+
+/**
+ * Default route in the main routing table, or the route to the internet resolved for the
+ * primary interface.
+ */
+struct default_route {
+    int ifindex;
+    std::uint32_t metric;
+    gateway_addr gateway;
+};
+
+/**
+ * DefaultRoutes keeps a persistent rtnetlink socket subscribed to route and policy rule
+ * changes of both ipv4 and ipv6, so that the routing table only needs to be dumped
+ * again when it is actually changed.
+ *
+ * The primary interface is resolved like `ip route get`, by looking up the route to a
+ * fixed address on the internet, so that policy routing (e.g. wg-quick) and split default
+ * routes (e.g. 0.0.0.0/1 and 128.0.0.0/1 of OpenVPN) are honoured.
+ */
+class DefaultRoutes {
+    /**
+     * Subscribed to routes and policy rules of ipv4 and ipv6
+     */
+    Fd notification_fd;
+    /**
+     * Used to send RTM_GETROUTE
+     */
+    Fd query_fd;
+
+    std::uint32_t seq = 0;
+    bool is_stale = true;
+
+    std::vector<default_route> routes;
+
+    /**
+     * Name of the interface which carries the route to the internet, ipv4 preferred,
+     * empty if there is none.
+     */
+    std::array<char, IFNAMSIZ> primary_name = {};
+    int primary_ifindex = 0;
+
+    std::unique_ptr<char[]> buffer;
+
+    /**
+     * Send req and call on_route with every RTM_NEWROUTE replied.
+     *
+     * @return 0 on success, otherwise errno of the failure.
+     */
+    template <class F>
+    int request(struct nlmsghdr &req, bool is_dump, F &&on_route);
+
+    /**
+     * @return false on failure, in which case routes are left unchanged.
+     */
+    bool dump();
+    /**
+     * Look up the route to the internet of family and add it to routes if its interface
+     * has no default route in the main table.
+     *
+     * @param ifindex set to the interface of the route, 0 if it is unreachable.
+     * @return false on failure.
+     */
+    bool lookup_primary(int family, int &ifindex);
+
+public:
+    DefaultRoutes();
+
+    /**
+     * The fd is to be passed to request_polling with read_ready.
+     */
+    int get_notification_fd() const noexcept;
+    /**
+     * Drain pending notifications.
+     *
+     * @return true if any default route has changed and update() needs to be called.
+     */
+    bool handle_notifications() noexcept;
+
+    /**
+     * Dump the routing table only if it is changed since the last call to update().
+     *
+     * If rtnetlink fails, the previous routes are kept and it is retried in the next call.
+     */
+    void update();
+
+    /**
+     * @return the default route with the lowest metric via ifindex or nullptr.
+     */
+    auto find(int ifindex) const noexcept -> const default_route*;
+
+    /**
+     * @return 0 if there is no route to the internet
+     */
+    int get_primary_ifindex() const noexcept;
+    /**
+     * @return empty string if there is no route to the internet
+     */
+    auto get_primary_name() const noexcept -> const char*;
+};
+} /* namespace swaystatus */
+
+template <>
+struct fmt::formatter<swaystatus::gateway_addr>: fmt::formatter<const char*>
+{
+    using gateway_addr = swaystatus::gateway_addr;
+
+    using format_context_it = typename format_context::iterator;
+
+    auto format(const gateway_addr &gateway, format_context &ctx) -> format_context_it;
+};
+
+#endif
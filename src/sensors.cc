@@ -1,132 +1,554 @@
-/**
- * Adapted from:
- * https://stackoverflow.com/questions/8556551/has-anyone-been-able-to-use-libsensors-properly
- */
-#include <cmath>
 #include <err.h>
+#include <errno.h>
+#include <fcntl.h>     /* For O_RDONLY */
+#include <unistd.h>    /* For pread and close */
+#include <dirent.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+
+#include <dlfcn.h>
 
 #include <sensors/sensors.h>
 
+#include "utility.h"
+#include "formatting/fmt_utility.hpp"
+#include "formatting/Conditional.hpp"
 #include "sensors.hpp"
 
+/*
+ * libsensors is not linked, but loaded by dlopen in load_libsensors(), so that swaystatus
+ * pays nothing for it unless use_libsensors is set.
+ *
+ * Every function of libsensors used here is resolved into a pointer libsensors_<name> and
+ * its name is redirected to the pointer with a macro.
+ */
+#define LIBSENSORS_FUNCTIONS(X)     \
+    X(sensors_cleanup)              \
+    X(sensors_get_detected_chips)   \
+    X(sensors_get_features)         \
+    X(sensors_get_label)            \
+    X(sensors_init)
+
+#define DEFINE_LIBSENSORS_FUNCTION(name) static decltype(&::name) libsensors_##name;
+LIBSENSORS_FUNCTIONS(DEFINE_LIBSENSORS_FUNCTION)
+#undef DEFINE_LIBSENSORS_FUNCTION
+
+#define sensors_cleanup (*libsensors_sensors_cleanup)
+#define sensors_get_detected_chips (*libsensors_sensors_get_detected_chips)
+#define sensors_get_features (*libsensors_sensors_get_features)
+#define sensors_get_label (*libsensors_sensors_get_label)
+#define sensors_init (*libsensors_sensors_init)
+
 namespace swaystatus {
-static auto sensor_get_int8_val(const sensors_chip_name &cn, const sensors_subfeature *subf)
+static void *libsensors;
+
+bool load_libsensors() noexcept
 {
-    double val;
-    if (sensors_get_value(&cn, subf->number, &val) < 0)
-        errx(1, "%s failed", "sensors_get_value");
+    if (libsensors)
+        return true;
+
+    void *lib = dlopen("libsensors.so.5", RTLD_NOW | RTLD_LOCAL);
+    if (lib == nullptr) {
+        warnx("%s on %s failed: %s", "dlopen", "libsensors.so.5", dlerror());
+        return false;
+    }
 
-    return static_cast<std::int8_t>(std::lround(val));
+#define LOAD_LIBSENSORS_FUNCTION(name)                                                  \
+    libsensors_##name = reinterpret_cast<decltype(libsensors_##name)>(dlsym(lib, #name)); \
+    if (libsensors_##name == nullptr) {                                                 \
+        warnx("%s on %s failed: %s", "dlsym", #name, dlerror());                        \
+        dlclose(lib);                                                                   \
+        return false;                                                                   \
+    }
+    LIBSENSORS_FUNCTIONS(LOAD_LIBSENSORS_FUNCTION)
+#undef LOAD_LIBSENSORS_FUNCTION
+
+    libsensors = lib;
+    return true;
 }
 
-Sensor::Sensor(const char *prefix, const char *path, int addr, short type, short nr) noexcept:
-    prefix{prefix}, path{path}, addr{addr}, bus{sensor_bus_type{type}, nr}
+static constexpr const char *hwmon_path = "/sys/class/hwmon/";
+static constexpr const char *thermal_path = "/sys/class/thermal/";
+
+struct sensor_type_info {
+    std::string_view name;
+    std::string_view unit;
+    /**
+     * To convert the value in sysfs to unit
+     */
+    long divisor;
+    sensors_feature_type feature;
+};
+/**
+ * Indexed by sensor_type
+ */
+static constexpr const sensor_type_info type_infos[] = {
+    {"temp",  "°C",  1000, SENSORS_FEATURE_TEMP},
+    {"fan",   "RPM", 1,    SENSORS_FEATURE_FAN},
+    {"in",    "mV",  1,    SENSORS_FEATURE_IN},
+    {"power", "mW",  1000, SENSORS_FEATURE_POWER},
+    {"curr",  "mA",  1,    SENSORS_FEATURE_CURR},
+};
+static constexpr const auto type_cnt = sizeof(type_infos) / sizeof(type_infos[0]);
+
+static auto get_type_info(sensor_type type) noexcept -> const sensor_type_info&
+{
+    return type_infos[static_cast<std::size_t>(type)];
+}
+auto get_sensor_type_name(sensor_type type) noexcept -> std::string_view
+{
+    return get_type_info(type).name;
+}
+auto get_sensor_type_unit(sensor_type type) noexcept -> std::string_view
+{
+    return get_type_info(type).unit;
+}
+auto parse_sensor_type(const char *str) noexcept -> std::uint8_t
+{
+    for (std::size_t i = 0; i != type_cnt; ++i) {
+        if (type_infos[i].name == str)
+            return 1 << i;
+    }
+    return 0;
+}
+
+Sensor::Sensor(std::string &&prefix, std::string &&path) noexcept:
+    prefix{std::move(prefix)}, path{std::move(path)}
 {}
 
-auto Sensor::get_adapter_name() const noexcept -> std::string_view
+sensor_reading::sensor_reading(
+    std::uint32_t sensor, sensor_type type, int number, std::string &&label, Fd &&input_fd
+) noexcept:
+    sensor{sensor}, type{type}, number{number}, label{std::move(label)},
+    input_fd{std::move(input_fd)}
+{}
+
+static bool starts_with(const char *str, std::string_view prefix) noexcept
 {
-    const sensors_bus_id bus_id = {
-        .type = bus.type.val,
-        .nr = bus.nr
+    return std::strncmp(str, prefix.data(), prefix.size()) == 0;
+}
+
+/**
+ * @return -1 if failed to open
+ */
+static int open_attr(int dirfd, const char *name) noexcept
+{
+    return openat(dirfd, name, O_RDONLY | O_CLOEXEC);
+}
+/**
+ * Read the whole attribute with trailing newline removed.
+ *
+ * @return false if the attribute does not exist or cannot be read
+ */
+static bool read_attr(int dirfd, const char *name, std::string &buffer)
+{
+    int fd = open_attr(dirfd, name);
+    if (fd < 0)
+        return false;
+
+    buffer.clear();
+    ssize_t cnt = asreadall(fd, buffer);
+    close(fd);
+    if (cnt < 0)
+        return false;
+
+    while (!buffer.empty() && (buffer.back() == '\n' || buffer.back() == '\0'))
+        buffer.pop_back();
+
+    return true;
+}
+
+/**
+ * @return false if the attribute cannot be read, e.g. the device is gone.
+ */
+static bool read_long(int fd, long *val) noexcept
+{
+    char buffer[32];
+
+    ssize_t cnt;
+    do {
+        cnt = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    } while (cnt < 0 && errno == EINTR);
+    if (cnt <= 0)
+        return false;
+    buffer[cnt] = '\0';
+
+    char *endptr;
+    errno = 0;
+    *val = std::strtol(buffer, &endptr, 10);
+    return endptr != buffer && errno == 0;
+}
+/**
+ * @return false if fd is not valid or the alarm is not raised.
+ */
+static bool read_flag(const Fd &fd) noexcept
+{
+    long val;
+    return fd && read_long(fd.get(), &val) && val != 0;
+}
+static auto convert_value(sensor_type type, long raw) noexcept -> std::int32_t
+{
+    const long divisor = get_type_info(type).divisor;
+    const long half = divisor / 2;
+    long val = (raw + (raw < 0 ? -half : half)) / divisor;
+    return static_cast<std::int32_t>(std::clamp<long>(val, INT32_MIN + 1, INT32_MAX));
+}
+
+/**
+ * @param fn called with (dirfd, d_name) for every entry except for "." and ".."
+ * @return false if the dir does not exist
+ */
+template <class F>
+static bool visit_dir(int fd, F &&fn)
+{
+    DIR *dir = fdopendir(fd);
+    if (!dir) {
+        close(fd);
+        return false;
+    }
+
+    for (struct dirent *ent; (ent = readdir(dir)); ) {
+        if (std::strcmp(ent->d_name, ".") != 0 && std::strcmp(ent->d_name, "..") != 0)
+            fn(dirfd(dir), ent->d_name);
+    }
+
+    closedir(dir);
+    return true;
+}
+template <class F>
+static bool visit_dir(const char *path, F &&fn)
+{
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT)
+            return false;
+        err(1, "%s on %s failed", "open", path);
+    }
+
+    return visit_dir(fd, std::forward<F>(fn));
+}
+
+void Sensors::add_hwmon(int dirfd, const char *d_name)
+{
+    int fd = openat(dirfd, d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    std::string path = hwmon_path;
+    path.append(d_name);
+    std::string attr_path = path;
+
+    std::string prefix;
+    if (!read_attr(fd, "name", prefix)) {
+        // Old drivers put their attributes in device/
+        int device_fd = openat(fd, "device", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        close(fd);
+        if (device_fd < 0)
+            return;
+
+        fd = device_fd;
+        attr_path.append("/device");
+        if (!read_attr(fd, "name", prefix)) {
+            close(fd);
+            return;
+        }
+    }
+
+    if (!filter.chips.matches(prefix.c_str())) {
+        close(fd);
+        return;
+    }
+
+    const auto sensor = static_cast<std::uint32_t>(sensors.size());
+    const auto readings_begin = readings.size();
+
+    visit_dir(fd, [&](int attr_fd, const char *name) {
+        // Looking for <type><N>_input
+        for (std::size_t i = 0; i != type_cnt; ++i) {
+            const auto type_name = type_infos[i].name;
+            if (!(filter.types & (1 << i)) || !starts_with(name, type_name))
+                continue;
+
+            const char *number_str = name + type_name.size();
+            char *endptr;
+            long number = std::strtol(number_str, &endptr, 10);
+            if (endptr == number_str || std::strcmp(endptr, "_input") != 0)
+                continue;
+
+            add_reading(attr_fd, sensor, static_cast<sensor_type>(i), number);
+            return;
+        }
+    });
+
+    if (readings.size() == readings_begin)
+        return;
+
+    // readdir returns entries in arbitrary order
+    std::sort(
+        readings.begin() + readings_begin, readings.end(),
+        [](const auto &x, const auto &y) noexcept {
+            if (x.type != y.type)
+                return x.type < y.type;
+            return x.number < y.number;
+        }
+    );
+
+    sensors.emplace_back(std::move(prefix), std::move(path));
+    sensors.back().attr_path = std::move(attr_path);
+}
+void Sensors::add_reading(int attr_fd, std::uint32_t sensor, sensor_type type, long number)
+{
+    const auto type_name = get_type_info(type).name;
+    char name[32];
+
+    auto get_attr_name = [&](const char *suffix) noexcept {
+        std::snprintf(name, sizeof(name), "%.*s%ld_%s",
+                      static_cast<int>(type_name.size()), type_name.data(), number, suffix);
+        return name;
     };
-    const char *ret = sensors_get_adapter_name(&bus_id);
-    if (ret)
-        return ret;
-    else
-        return {};
+
+    int input_fd = open_attr(attr_fd, get_attr_name("input"));
+    if (input_fd < 0)
+        return;
+
+    std::string label;
+    if (!read_attr(attr_fd, get_attr_name("label"), label)) {
+        label = type_name;
+        label.append(std::to_string(number));
+    }
+
+    auto &reading = readings.emplace_back(
+        sensor, type, static_cast<int>(number), std::move(label), Fd{input_fd}
+    );
+
+    int alarm_fd = open_attr(attr_fd, get_attr_name("alarm"));
+    if (alarm_fd >= 0)
+        reading.alarm_fd = Fd{alarm_fd};
+
+    int crit_alarm_fd = open_attr(attr_fd, get_attr_name("crit_alarm"));
+    if (crit_alarm_fd >= 0)
+        reading.crit_alarm_fd = Fd{crit_alarm_fd};
+
+    // The critical limit rarely changes, so it is only read once here
+    int crit_fd = open_attr(attr_fd, get_attr_name("crit"));
+    if (crit_fd >= 0) {
+        long crit;
+        if (read_long(crit_fd, &crit))
+            reading.crit = convert_value(type, crit);
+        close(crit_fd);
+    }
 }
-void Sensor::update(Sensors &sensors)
+void Sensors::add_thermal_zone(int dirfd, const char *d_name)
 {
+    int fd = openat(dirfd, d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    std::string path = thermal_path;
+    path.append(d_name);
+
     /*
-     * The const_cast is used only to maintain compatibility with the sensors_bus_id defined in
-     * sensors/sensors.h
+     * Thermal zones that register a hwmon device have a hwmon* subdir and are already
+     * read from /sys/class/hwmon.
      */
-    const sensors_chip_name cn = {
-        .prefix = const_cast<char*>(prefix.c_str()),
-        .bus = sensors_bus_id{
-            .type = bus.type.val,
-            .nr = bus.nr
-        },
-        .addr = addr,
-        .path = const_cast<char*>(path.c_str())
-    };
+    bool has_hwmon = !(filter.types & (1 << static_cast<unsigned>(sensor_type::temp)));
+    int dup_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (dup_fd >= 0) {
+        visit_dir(dup_fd, [&](int, const char *name) {
+            if (starts_with(name, "hwmon"))
+                has_hwmon = true;
+        });
+    }
+
+    std::string prefix;
+    int input_fd = -1;
+    if (!has_hwmon && read_attr(fd, "type", prefix) && filter.chips.matches(prefix.c_str()))
+        input_fd = open_attr(fd, "temp");
+    close(fd);
+
+    if (input_fd < 0)
+        return;
 
-    sensors_feature const *feat;
-    int f = 0;
+    readings.emplace_back(
+        static_cast<std::uint32_t>(sensors.size()), sensor_type::temp, 1, "temp1", Fd{input_fd}
+    );
+    sensors.emplace_back(std::move(prefix), std::move(path));
+}
 
-    while ((feat = sensors_get_features(&cn, &f)) != nullptr) {
-        if (feat->type != SENSORS_FEATURE_TEMP)
+void Sensors::read_libsensors_labels()
+{
+    sensors_chip_name const *cn;
+    int c = 0;
+    while ((cn = sensors_get_detected_chips(nullptr, &c)) != nullptr) {
+        auto it = std::find_if(sensors.begin(), sensors.end(), [cn](const Sensor &sensor) {
+            return sensor.attr_path == cn->path;
+        });
+        if (it == sensors.end())
             continue;
 
-        auto &reading = sensors.readings.emplace_back(this, feat->number);
+        it->addr = cn->addr;
+        it->bus = sensor_bus_id{sensor_bus_type{cn->bus.type}, cn->bus.nr};
 
-        sensors_subfeature const *subf;
-        int s = 0;
+        const auto sensor = static_cast<std::uint32_t>(it - sensors.begin());
 
-        std::uint8_t cnt = 0;
-        while ((subf = sensors_get_all_subfeatures(&cn, feat, &s)) != nullptr) {
-            if ((subf->flags & SENSORS_MODE_R) == 0)
+        sensors_feature const *feat;
+        int f = 0;
+        while ((feat = sensors_get_features(cn, &f)) != nullptr) {
+            auto *info = std::find_if(
+                type_infos, type_infos + type_cnt,
+                [feat](const auto &info) noexcept { return info.feature == feat->type; }
+            );
+            if (info == type_infos + type_cnt)
                 continue;
 
-            std::int8_t *result;
-            switch (subf->type) {
-                default:
+            const auto type = static_cast<sensor_type>(info - type_infos);
+            const int number = std::atoi(feat->name + info->name.size());
+            for (auto &reading: readings) {
+                if (reading.sensor != sensor || reading.type != type || reading.number != number)
                     continue;
 
-                case SENSORS_SUBFEATURE_TEMP_INPUT:
-                    result = &reading.temp;
-                    break;
+                char *label = sensors_get_label(cn, feat);
+                if (label) {
+                    reading.label = label;
+                    std::free(label);
+                }
+                break;
             }
-
-            *result = sensor_get_int8_val(cn, subf);
-            ++cnt;
         }
-
-        /**
-         * Check if the reading contains any valid data
-         *
-         * On my computer, BAT0 always return subfeatures that have no TEMP_INPUT,
-         * so this is necessary.
-         */
-        if (cnt == 0)
-            sensors.readings.pop_back();
     }
 }
 
-sensor_reading::sensor_reading(Sensor *sensor, int number) noexcept:
-    sensor{sensor}, number{number}
-{}
-
-Sensors::Sensors()
+Sensors::Sensors(bool use_libsensors, sensors_filter &&filter):
+    use_libsensors{use_libsensors}, filter{std::move(filter)}
 {
-    if (sensors_init(nullptr) != 0)
+    if (use_libsensors && sensors_init(nullptr) != 0)
         errx(1, "%s failed", "sensors_init");
     reload();
 }
+Sensors::~Sensors()
+{
+    if (use_libsensors)
+        sensors_cleanup();
+}
 
 void Sensors::reload()
 {
     sensors.clear();
     readings.clear();
 
-    sensors_chip_name const * cn;
-    int c = 0;
-    while ((cn = sensors_get_detected_chips(NULL, &c)) != 0) {
-        const auto &bus = cn->bus;
-        sensors.emplace_back(cn->prefix, cn->path, cn->addr, bus.type, bus.nr);
+    visit_dir(hwmon_path, [this](int dirfd, const char *d_name) {
+        if (starts_with(d_name, "hwmon"))
+            add_hwmon(dirfd, d_name);
+    });
+    visit_dir(thermal_path, [this](int dirfd, const char *d_name) {
+        if (starts_with(d_name, "thermal_zone"))
+            add_thermal_zone(dirfd, d_name);
+    });
+
+    if (use_libsensors)
+        read_libsensors_labels();
+
+    // Labels can only be filtered after libsensors is consulted
+    if (!filter.labels.is_empty()) {
+        auto it = std::remove_if(readings.begin(), readings.end(), [this](const auto &reading) {
+            return !filter.labels.matches(reading.label.c_str());
+        });
+        readings.erase(it, readings.end());
     }
 
+    max_temp = sensor_reading::invalid;
+    avg_temp = sensor_reading::invalid;
+    hottest = readings.size();
+    alarm_cnt = 0;
+
     sensors.shrink_to_fit();
+    readings.shrink_to_fit();
 }
 
-void Sensors::update()
+void Sensors::update() noexcept
 {
-    readings.clear();
+    constexpr const auto invalid = sensor_reading::invalid;
 
-    for (auto &sensor: sensors)
-        sensor.update(*this);
+    long long sum = 0;
+    std::size_t cnt = 0;
 
-    readings.shrink_to_fit();
+    max_temp = invalid;
+    hottest = readings.size();
+    alarm_cnt = 0;
+
+    for (std::size_t i = 0; i != readings.size(); ++i) {
+        auto &reading = readings[i];
+
+        long raw;
+        if (read_long(reading.input_fd.get(), &raw))
+            reading.value = convert_value(reading.type, raw);
+        else
+            reading.value = invalid;
+
+        const bool is_valid = reading.value != invalid;
+
+        reading.is_alarm = read_flag(reading.alarm_fd);
+        reading.is_crit = read_flag(reading.crit_alarm_fd) ||
+            (is_valid && reading.crit != invalid && reading.value >= reading.crit);
+        if (reading.is_alarm || reading.is_crit)
+            ++alarm_cnt;
+
+        if (reading.type != sensor_type::temp || !is_valid)
+            continue;
+
+        sum += reading.value;
+        ++cnt;
+        if (reading.value > max_temp) {
+            max_temp = reading.value;
+            hottest = i;
+        }
+    }
+
+    if (cnt == 0) {
+        avg_temp = invalid;
+    } else {
+        long long half = static_cast<long long>(cnt / 2);
+        avg_temp = (sum + (sum < 0 ? -half : half)) / static_cast<long long>(cnt);
+    }
+}
+
+auto Sensors::get_sensor(const sensor_reading &reading) const noexcept -> const Sensor&
+{
+    return sensors[reading.sensor];
+}
+
+bool Sensors::is_empty() const noexcept
+{
+    return readings.empty();
+}
+auto Sensors::size() const noexcept -> std::size_t
+{
+    return readings.size();
+}
+
+auto Sensors::get_max_temp() const noexcept -> std::int32_t
+{
+    return max_temp;
+}
+auto Sensors::get_avg_temp() const noexcept -> std::int32_t
+{
+    return avg_temp;
+}
+auto Sensors::get_hottest() const noexcept -> const sensor_reading*
+{
+    if (hottest == readings.size())
+        return nullptr;
+    return &readings[hottest];
+}
+
+auto Sensors::get_alarm_count() const noexcept -> std::size_t
+{
+    return alarm_cnt;
 }
 
 auto Sensors::begin() const noexcept -> const_iterator
@@ -148,6 +570,61 @@ auto Sensors::cend() const noexcept -> const_iterator
 }
 } /* namespace swaystatus */
 
+using Sensors_formatter = fmt::formatter<swaystatus::Sensors>;
+
+auto Sensors_formatter::parse(format_parse_context &ctx) -> format_parse_context_it
+{
+    auto it = ctx.begin(), end = ctx.end();
+    if (it == end)
+        return it;
+
+    end = swaystatus::find_end_of_format(ctx);
+
+    fmt_str = std::string_view{it, static_cast<std::size_t>(end - it)};
+
+    return end;
+}
+auto Sensors_formatter::format(const Sensors &sensors, format_context &ctx) -> format_context_it
+{
+    auto out = ctx.out();
+
+    if (fmt_str.size() == 0)
+        return out;
+
+    std::size_t i = 0;
+    for (const auto &reading: sensors) {
+        const auto &sensor = sensors.get_sensor(reading);
+
+        out = format_to(
+            out,
+            fmt_str,
+            fmt::arg("prefix",   sensor.prefix),
+            fmt::arg("path",     sensor.path),
+            fmt::arg("addr",     sensor.addr),
+            fmt::arg("bus_type", sensor.bus.type),
+            fmt::arg("bus_nr",   sensor.bus.nr),
+
+            fmt::arg("reading_number", reading.number),
+            fmt::arg("reading_label",  reading.label),
+            fmt::arg("reading_type",   swaystatus::get_sensor_type_name(reading.type)),
+            fmt::arg("reading_unit",   swaystatus::get_sensor_type_unit(reading.type)),
+            fmt::arg("reading_value",  reading.value),
+            fmt::arg("reading_crit",   reading.crit),
+            fmt::arg("reading_temp",   reading.value),
+
+            fmt::arg("is_alarm", swaystatus::Conditional{reading.is_alarm}),
+            fmt::arg("is_crit",  swaystatus::Conditional{reading.is_crit})
+        );
+
+        if (++i != sensors.size()) {
+            *out = ' ';
+            ++out;
+        }
+    }
+
+    return out;
+}
+
 using formatter = fmt::formatter<swaystatus::sensor_bus_type>;
 
 static auto bus_type_to_str(const swaystatus::sensor_bus_type &type) noexcept -> std::string_view
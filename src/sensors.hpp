@@ -10,6 +10,9 @@
 # include <array>
 # include <vector>
 
+# include "Fd.hpp"
+# include "NameFilter.hpp"
+
 # include "formatting/fmt/include/fmt/format.h"
 
 namespace swaystatus {
@@ -21,51 +24,193 @@ struct sensor_bus_id {
     short nr;
 };
 
-class Sensors;
+/**
+ * A hwmon device or a thermal zone
+ */
 struct Sensor {
+    /**
+     * Content of hwmon*\/name or thermal_zone*\/type
+     */
     std::string prefix;
+    /**
+     * Path to the device in /sys
+     */
     std::string path;
-    int addr;
+    /**
+     * Directory the attributes are read from, which is path/device for old hwmon drivers,
+     * same as sensors_chip_name::path of libsensors.
+     * Empty for thermal zones.
+     */
+    std::string attr_path;
 
-    sensor_bus_id bus;
+    /**
+     * addr and bus are only available if libsensors is used, otherwise they are set to
+     * -1 (SENSORS_BUS_TYPE_ANY, SENSORS_BUS_NR_ANY).
+     */
+    int addr = -1;
+    sensor_bus_id bus = {sensor_bus_type{-1}, -1};
 
-    Sensor(const char *prefix, const char *path, int addr, short type, short nr) noexcept;
+    Sensor(std::string &&prefix, std::string &&path) noexcept;
+};
 
-    void update(Sensors &sensors);
-    auto get_adapter_name() const noexcept -> std::string_view;
+enum class sensor_type: std::uint8_t {
+    /**
+     * In degree Celsius
+     */
+    temp,
+    /**
+     * In RPM
+     */
+    fan,
+    /**
+     * Voltage in mV
+     */
+    in,
+    /**
+     * In mW
+     */
+    power,
+    /**
+     * Current in mA
+     */
+    curr,
 };
+/**
+ * @return name used in hwmon, e.g. "temp"
+ */
+auto get_sensor_type_name(sensor_type type) noexcept -> std::string_view;
+auto get_sensor_type_unit(sensor_type type) noexcept -> std::string_view;
+/**
+ * @param str can be "temp", "fan", "in", "power" or "curr"
+ * @return 0 if str is not a valid type, otherwise 1 << type
+ */
+auto parse_sensor_type(const char *str) noexcept -> std::uint8_t;
 
 struct sensor_reading {
-    Sensor *sensor;
+    static constexpr const std::int32_t invalid = std::numeric_limits<std::int32_t>::min();
 
+    /**
+     * Index of the Sensor in Sensors
+     */
+    std::uint32_t sensor;
+
+    sensor_type type;
+
+    /**
+     * N in <type><N>_input, always 1 for thermal zones.
+     */
     int number;
 
-    sensor_reading(Sensor *sensor, int number) noexcept;
+    /**
+     * Read from <type><N>_label (or libsensors if enabled) once in Sensors::reload().
+     * Defaults to "<type><N>".
+     */
+    std::string label;
 
     /**
-     * It is unlikely that a compuer can run under temperature outside of range
-     * [-126, 125]
+     * Opened in Sensors::reload() and reused in every Sensors::update().
      *
-     * It might be a good idea in future to add field temp_critical_alarm so that
-     * swaystatus can set urgent according to that
-     *
-     * There's also other interesting meteric, listed in /usr/include/sensors/sensors.h
+     * alarm_fd and crit_alarm_fd are <type><N>_alarm and <type><N>_crit_alarm,
+     * which might not exist.
+     */
+    Fd input_fd;
+    Fd alarm_fd;
+    Fd crit_alarm_fd;
+
+    /**
+     * In unit of type, set to invalid if it cannot be read.
+     */
+    std::int32_t value = invalid;
+    /**
+     * Read from <type><N>_crit once in Sensors::reload(), invalid if not present.
+     */
+    std::int32_t crit = invalid;
+
+    /**
+     * Set if <type><N>_alarm is raised.
      */
-    std::int8_t temp = std::numeric_limits<std::int8_t>::min();
+    bool is_alarm = false;
+    /**
+     * Set if crit_alarm is raised or value reaches crit.
+     */
+    bool is_crit = false;
+
+    sensor_reading(std::uint32_t sensor, sensor_type type, int number, std::string &&label,
+                   Fd &&input_fd) noexcept;
 };
 
+/**
+ * Filters applied in Sensors::reload(), thus filtered readings are never read.
+ */
+struct sensors_filter {
+    /**
+     * Matched against Sensor::prefix
+     */
+    NameFilter chips;
+    /**
+     * Matched against sensor_reading::label
+     */
+    NameFilter labels;
+    /**
+     * Bitwise or of 1 << sensor_type
+     */
+    std::uint8_t types = 1 << static_cast<unsigned>(sensor_type::temp);
+};
+
+/**
+ * Load libsensors on the first call.
+ *
+ * @return false if libsensors is not available, with the reason printed to stderr.
+ */
+bool load_libsensors() noexcept;
+
+/**
+ * Sensors reads temperature, fan, voltage, power and current from /sys/class/hwmon
+ * and temperature from /sys/class/thermal directly.
+ *
+ * All *_input and *_alarm are located and opened in reload(), so that update() only needs
+ * to call pread once per file and never allocates.
+ *
+ * libsensors is only used to get labels (which can be configured in sensors.conf),
+ * addr and bus of the chips if use_libsensors is true.
+ */
 class Sensors {
     std::vector<Sensor> sensors;
     std::vector<sensor_reading> readings;
 
-    friend Sensor;
+    bool use_libsensors;
+    sensors_filter filter;
+
+    /**
+     * Aggregates of valid temperature readings, computed in update().
+     */
+    std::int32_t max_temp = sensor_reading::invalid;
+    std::int32_t avg_temp = sensor_reading::invalid;
+    /**
+     * Index of the hottest reading, readings.size() if there is no valid reading.
+     */
+    std::size_t hottest = 0;
+
+    /**
+     * Number of readings with is_alarm or is_crit set
+     */
+    std::size_t alarm_cnt = 0;
+
+    void add_reading(int attr_fd, std::uint32_t sensor, sensor_type type, long number);
+
+    void add_hwmon(int dirfd, const char *d_name);
+    void add_thermal_zone(int dirfd, const char *d_name);
+    void read_libsensors_labels();
 
 public:
     /**
-     * Initialize libsensors and get a list of sensors on the system
-     * You need to call update() after ctor to fetch the readings, otherwise begin() == end().
+     * Get a list of sensors on the system.
+     * You need to call update() after ctor to fetch the readings.
+     *
+     * @param use_libsensors initialize libsensors and use it to get labels, addr and bus,
+     *                       load_libsensors() must have succeeded if it is true.
      */
-    Sensors();
+    Sensors(bool use_libsensors, sensors_filter &&filter);
 
     Sensors(const Sensors&) = delete;
     Sensors(Sensors&&) = delete;
@@ -73,9 +218,32 @@ public:
     Sensors& operator = (const Sensors&) = delete;
     Sensors& operator = (Sensors&&) = delete;
 
+    ~Sensors();
+
     void reload();
 
-    void update();
+    /**
+     * Read all readings and compute the aggregates in one pass.
+     */
+    void update() noexcept;
+
+    auto get_sensor(const sensor_reading &reading) const noexcept -> const Sensor&;
+
+    bool is_empty() const noexcept;
+    auto size() const noexcept -> std::size_t;
+
+    /**
+     * get_max_temp() and get_avg_temp() return sensor_reading::invalid
+     * if there is no valid temperature reading.
+     */
+    auto get_max_temp() const noexcept -> std::int32_t;
+    auto get_avg_temp() const noexcept -> std::int32_t;
+    /**
+     * @return nullptr if there is no valid temperature reading.
+     */
+    auto get_hottest() const noexcept -> const sensor_reading*;
+
+    auto get_alarm_count() const noexcept -> std::size_t;
 
     using const_iterator = std::vector<sensor_reading>::const_iterator;
 
@@ -87,6 +255,20 @@ public:
 };
 } /* namespace swaystatus */
 
+template <>
+struct fmt::formatter<swaystatus::Sensors>
+{
+    using Sensors = swaystatus::Sensors;
+
+    using format_parse_context_it = typename format_parse_context::iterator;
+    using format_context_it = typename format_context::iterator;
+
+    std::string_view fmt_str = "";
+
+    auto parse(format_parse_context &ctx) -> format_parse_context_it;
+    auto format(const Sensors &sensors, format_context &ctx) -> format_context_it;
+};
+
 template <>
 struct fmt::formatter<swaystatus::sensor_bus_type>:
     fmt::formatter<std::string_view>
@@ -0,0 +1,42 @@
+#include "sparkline.hpp"
+
+namespace swaystatus {
+auto get_bar(std::uint64_t value, std::uint64_t max) noexcept -> const char*
+{
+    static constexpr const char * const levels[] = {
+        "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█",
+    };
+    constexpr const std::uint64_t max_level = sizeof(levels) / sizeof(levels[0]) - 1;
+
+    if (value >= max)
+        return levels[max_level];
+    return levels[(value * max_level + max / 2) / max];
+}
+} /* namespace swaystatus */
+
+using sparkline_formatter = fmt::formatter<swaystatus::sparkline>;
+
+auto sparkline_formatter::parse(format_parse_context &ctx) -> format_parse_context_it
+{
+    return ctx.begin();
+}
+auto sparkline_formatter::format(const sparkline &line, format_context &ctx) -> format_context_it
+{
+    const auto &samples = line.samples;
+
+    auto out = ctx.out();
+
+    auto max = samples.max();
+    // All bars are the lowest if there is no activity at all
+    if (max == 0)
+        max = 1;
+
+    for (std::size_t i = 0; i != samples.size(); ++i) {
+        for (const char *bar = swaystatus::get_bar(samples[i], max); *bar != '\0'; ++bar) {
+            *out = *bar;
+            ++out;
+        }
+    }
+
+    return out;
+}
@@ -0,0 +1,39 @@
+#ifndef  __swaystatus_sparkline_HPP__
+# define __swaystatus_sparkline_HPP__
+
+# include <cstdint>
+
+# include "RingBuffer.hpp"
+
+# include "formatting/fmt_config.hpp"
+# include "formatting/fmt/include/fmt/format.h"
+
+namespace swaystatus {
+/**
+ * @param max must not be 0
+ * @return one of "▁".."█" representing value / max
+ */
+auto get_bar(std::uint64_t value, std::uint64_t max) noexcept -> const char*;
+
+/**
+ * Samples in RingBuffer rendered as bars scaled to the largest one, oldest first,
+ * e.g. "▁▁▃█▂".
+ */
+struct sparkline {
+    const RingBuffer<std::uint64_t> &samples;
+};
+} /* namespace swaystatus */
+
+template <>
+struct fmt::formatter<swaystatus::sparkline>
+{
+    using sparkline = swaystatus::sparkline;
+
+    using format_parse_context_it = typename format_parse_context::iterator;
+    using format_context_it = typename format_context::iterator;
+
+    auto parse(format_parse_context &ctx) -> format_parse_context_it;
+    auto format(const sparkline &line, format_context &ctx) -> format_context_it;
+};
+
+#endif
@@ -22,6 +22,7 @@
 #include "utility.h"
 #include "formatting/printer.hpp"
 #include "Callback/python3.hpp"
+#include "Callback/dynlib.hpp"
 #include "process_configuration.h"
 #include "modules/Base.hpp"
 #include "poller.h"
@@ -48,6 +49,26 @@ static void handle_reload_request(int sig)
     reload_requested = true;
 }
 
+using Modules = std::vector<std::unique_ptr<modules::Base>>;
+
+static void print_blocks_impl(Modules &modules, bool is_tick)
+{
+    print_literal_str("[");
+
+    {
+#ifdef USE_PYTHON
+        /* Python callbacks called in this round only acquire the GIL once */
+        swaystatus::python::Interpreter::Batch_scoped batch;
+#endif
+
+        for (auto &module: modules)
+            module->update_and_print(is_tick);
+    }
+
+    /* Print dummy */
+    print_literal_str("{}],\n");
+    flush();
+}
 static void print_blocks(int fd, enum Event events, void *data)
 {
     static const uintmax_t trim_interval = 3660;
@@ -59,16 +80,10 @@ static void print_blocks(int fd, enum Event events, void *data)
 
     (void) events;
 
-    auto &modules = *static_cast<std::vector<std::unique_ptr<modules::Base>>*>(data);
+    /* Immediate updates requested in this round of polling are handled here */
+    modules::consume_immediate_update_request();
 
-    print_literal_str("[");
-
-    for (auto &module: modules)
-        module->update_and_print();
-
-    /* Print dummy */
-    print_literal_str("{}],\n");
-    flush();
+    print_blocks_impl(*static_cast<Modules*>(data), true);
 
     read_timer(fd);
 
@@ -124,19 +139,19 @@ int main(int argc, char* argv[])
 
     init_poller();
 
-#ifdef USE_PYTHON
-    if (!is_reload) {
-        if (config_filename) {
-            char *file = strdup_checked(config_filename);
-            char *path = dirname(file);
+    {
+        char *file = config_filename ? strdup_checked(config_filename) : NULL;
+        char *path = file ? dirname(file) : NULL;
 
+        /* The working directory is already "/" on reload, so it is inherited like PYTHONPATH */
+        setup_dlpath(path, is_reload);
+#ifdef USE_PYTHON
+        if (!is_reload)
             setup_pythonpath(path);
+#endif
 
-            free(file);
-        } else
-            setup_pythonpath(NULL);
+        free(file);
     }
-#endif
 
     auto modules = modules::makeModules(config);
 
@@ -161,6 +176,9 @@ int main(int argc, char* argv[])
 
     do {
         perform_polling(-1);
+
+        if (modules::consume_immediate_update_request())
+            print_blocks_impl(modules, false);
     } while (!reload_requested);
 
     if (reload_requested) {
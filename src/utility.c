@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
+#include <time.h>
 
 #include <execinfo.h>
 
@@ -132,6 +133,12 @@ uint64_t read_timer(int timerfd)
 
     return ret;
 }
+uint64_t get_monotonic_timestamp()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
 
 void sigaction_checked_impl(int sig, const char *signame, void (*sighandler)(int signum))
 {
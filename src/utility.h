@@ -64,6 +64,11 @@ int create_pollable_monotonic_timer(uintmax_t msec);
  */
 uint64_t read_timer(int timerfd);
 
+/**
+ * @return CLOCK_MONOTONIC in nanoseconds.
+ */
+uint64_t get_monotonic_timestamp();
+
 void set_terminate_handler(void (*handler)());
 
 void sigaction_checked_impl(int sig, const char *signame, void (*sighandler)(int signum));
@@ -130,7 +135,9 @@ void visit_all_subdirs(const char *path, subdir_visiter visiter, ...);
 # ifdef __cplusplus
 }
 
+#  include <cstdint>
 #  include <string>
+#  include <vector>
 #  include <initializer_list>
 #  include <type_traits>
 
@@ -145,6 +152,42 @@ std::string getcwd_checked();
  */
 ssize_t asreadall(int fd, std::string &buffer);
 
+/**
+ * @param buffer must not be empty
+ * @return -1 if read failed, error code is stored in errno.
+ *
+ * Read the whole file from offset 0 using pread, so the fd can be reused
+ * without lseek.
+ * If buffer isn't large enough, then aspreadall will double it.
+ * The read in buffer will be zero-terminated.
+ */
+ssize_t aspreadall(int fd, std::vector<char> &buffer);
+
+constexpr bool is_digit(char c) noexcept
+{
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+/**
+ * Skip spaces and parse an unsigned integer.
+ *
+ * If p is null-terminated, this never reads past the end.
+ *
+ * @return pointer to the first character after the integer
+ */
+template <class Char>
+constexpr auto parse_uint(Char *p, std::uint64_t *val) noexcept -> Char*
+{
+    while (*p == ' ')
+        ++p;
+
+    std::uint64_t result = 0;
+    for (; is_digit(*p); ++p)
+        result = result * 10 + static_cast<unsigned>(*p - '0');
+
+    *val = result;
+    return p;
+}
+
 constexpr bool is_all_true(std::initializer_list<bool> list)
 {
     for (bool each: list) {
@@ -0,0 +1,86 @@
+#include <err.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>        /* For read and write */
+#include <sys/eventfd.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "worker_pool.hpp"
+
+namespace swaystatus {
+WorkerPool::WorkerPool(std::size_t n):
+    notification_fd{eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)}
+{
+    if (!notification_fd)
+        err(1, "%s failed", "eventfd");
+
+    // Threads inherit the signal mask.
+    sigset_t all, old;
+    sigfillset(&all);
+    if (int ret = pthread_sigmask(SIG_SETMASK, &all, &old); ret != 0)
+        errx(1, "%s failed: %s", "pthread_sigmask", std::strerror(ret));
+
+    threads.reserve(n);
+    for (std::size_t i = 0; i != n; ++i)
+        threads.emplace_back(&WorkerPool::run, this);
+
+    if (int ret = pthread_sigmask(SIG_SETMASK, &old, nullptr); ret != 0)
+        errx(1, "%s failed: %s", "pthread_sigmask", std::strerror(ret));
+}
+
+void WorkerPool::run()
+{
+    for (;;) {
+        std::pair<Job, void*> job;
+        {
+            std::unique_lock lock{mutex};
+            cv.wait(lock, [this]() noexcept { return !jobs.empty(); });
+
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        job.first(job.second);
+    }
+}
+
+void WorkerPool::submit(Job job, void *data)
+{
+    {
+        std::lock_guard lock{mutex};
+        jobs.emplace_back(job, data);
+    }
+    cv.notify_one();
+}
+
+void WorkerPool::notify() noexcept
+{
+    std::uint64_t val = 1;
+    ssize_t ret;
+    do {
+        ret = write(notification_fd.get(), &val, sizeof(val));
+    } while (ret < 0 && errno == EINTR);
+
+    // EAGAIN: the counter is about to overflow, which means the main thread will be woken up anyway.
+    if (ret < 0 && errno != EAGAIN)
+        err(1, "%s on %s failed", "write", "eventfd");
+}
+
+int WorkerPool::get_notification_fd() const noexcept
+{
+    return notification_fd.get();
+}
+void WorkerPool::consume_notification() noexcept
+{
+    std::uint64_t val;
+    ssize_t ret;
+    do {
+        ret = read(notification_fd.get(), &val, sizeof(val));
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret < 0 && errno != EAGAIN)
+        err(1, "%s on %s failed", "read", "eventfd");
+}
+} /* namespace swaystatus */
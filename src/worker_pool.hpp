@@ -0,0 +1,72 @@
+#ifndef  __swaystatus_worker_pool_HPP__
+# define __swaystatus_worker_pool_HPP__
+
+# include <cstddef>
+# include <condition_variable>
+# include <deque>
+# include <mutex>
+# include <thread>
+# include <utility>
+# include <vector>
+
+# include "Fd.hpp"
+
+namespace swaystatus {
+/**
+ * WorkerPool runs jobs that might block off the main thread.
+ *
+ * Once a job is done, it calls notify() to wake up the main thread polling on
+ * get_notification_fd().
+ *
+ * Signals are blocked in the worker threads, so they are always delivered to the main thread.
+ * WorkerPool is never destroyed since jobs might be stuck forever, it is torn down by
+ * exit() or exec() instead.
+ */
+class WorkerPool {
+public:
+    using Job = void (*)(void *data);
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::pair<Job, void*>> jobs;
+
+    std::vector<std::thread> threads;
+
+    /**
+     * eventfd
+     */
+    Fd notification_fd;
+
+    void run();
+
+public:
+    /**
+     * @param n number of threads, must not be 0
+     */
+    WorkerPool(std::size_t n);
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator = (const WorkerPool&) = delete;
+
+    ~WorkerPool() = delete;
+
+    void submit(Job job, void *data);
+
+    /**
+     * Thread safe
+     */
+    void notify() noexcept;
+
+    /**
+     * @return fd to be passed to request_polling with read_ready.
+     */
+    int get_notification_fd() const noexcept;
+    /**
+     * Called by the main thread once the fd is readable.
+     */
+    void consume_notification() noexcept;
+};
+} /* namespace swaystatus */
+
+#endif
@@ -0,0 +1,106 @@
+#include <time.h>
+
+#include <cstdio>
+#include <cstdint>
+#include <cassert>
+
+#include <string>
+
+#include "../../../src/proc_stat.hpp"
+
+using namespace swaystatus;
+
+/**
+ * Generate /proc/stat of a machine with core_cnt cores, with cpu<offline> missing
+ */
+static auto generate_proc_stat(std::size_t core_cnt, std::size_t offline, std::uint64_t tick)
+    -> std::string
+{
+    std::string result;
+
+    auto append_cpu = [&](const char *name, std::uint64_t scale) {
+        char line[256];
+        std::snprintf(line, sizeof(line), "%s %lu %lu %lu %lu %lu %lu %lu %lu 0 0\n",
+                      name,
+                      3 * tick * scale, 0UL, tick * scale, 6 * tick * scale,
+                      0UL, 0UL, 0UL, 0UL);
+        result.append(line);
+    };
+
+    append_cpu("cpu ", core_cnt - 1);
+    for (std::size_t i = 0; i != core_cnt; ++i) {
+        if (i == offline)
+            continue;
+
+        // "cpu" followed by the longest std::size_t
+        char name[sizeof("cpu") + 20];
+        std::snprintf(name, sizeof(name), "cpu%zu", i);
+        append_cpu(name, 1);
+    }
+
+    result.append("intr ");
+    result.append(std::to_string(1000 * tick));
+    for (std::size_t i = 0; i != 4096; ++i)
+        result.append(i % 7 == 0 ? " 12345" : " 0");
+    result.append("\nctxt ");
+    result.append(std::to_string(5000 * tick));
+    result.append("\nbtime 1700000000\nprocesses 123456\nprocs_running 3\nprocs_blocked 0\n"
+                  "softirq 100 1 2 3 4 5 6 7 8 9 10\n");
+
+    return result;
+}
+
+static std::uint64_t get_timestamp()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+int main()
+{
+    constexpr const std::size_t core_cnt = 256;
+    constexpr const std::size_t offline = 17;
+
+    const auto content1 = generate_proc_stat(core_cnt, offline, 100);
+    const auto content2 = generate_proc_stat(core_cnt, offline, 200);
+
+    proc_stat prev, curr;
+    assert(parse_proc_stat(content1.c_str(), content1.size(), prev));
+    assert(parse_proc_stat(content2.c_str(), content2.size(), curr));
+
+    assert(curr.cores.size() == core_cnt - 1);
+    assert(curr.core_ids[offline - 1] == offline - 1);
+    assert(curr.core_ids[offline] == offline + 1);
+    assert(curr.total.user == 3 * 200 * (core_cnt - 1));
+    assert(curr.intr == 1000 * 200);
+    assert(curr.ctxt == 5000 * 200);
+
+    // busy = user + system = 4 / 10
+    assert(get_busy_percentage(prev.total, curr.total) == 40);
+    for (std::size_t i = 0; i != curr.cores.size(); ++i)
+        assert(get_busy_percentage(prev.cores[i], curr.cores[i]) == 40);
+
+    // Going backwards must not underflow
+    assert(get_busy_percentage(curr.total, prev.total) == 0);
+
+    // Benchmark
+    constexpr const std::size_t iterations = 10000;
+
+    std::size_t parsed_cnt = 0;
+
+    const auto begin = get_timestamp();
+    for (std::size_t i = 0; i != iterations; ++i) {
+        const auto &content = i % 2 ? content1 : content2;
+        parsed_cnt += parse_proc_stat(content.c_str(), content.size(), curr);
+    }
+    const auto elapsed = get_timestamp() - begin;
+
+    assert(parsed_cnt == iterations);
+    (void) parsed_cnt;
+
+    std::printf("Parsing /proc/stat (%zu bytes) of %zu cores takes %lu ns on average\n",
+                content1.size(), core_cnt, static_cast<unsigned long>(elapsed / iterations));
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../../src/plugin.h"
+
+/**
+ * Overridden to build plugins that must be rejected.
+ */
+#ifndef ABI_VERSION
+# define ABI_VERSION SWAYSTATUS_PLUGIN_ABI_VERSION
+#endif
+
+struct state {
+    const struct swaystatus_plugin_host *host;
+    void *module;
+    int pipefd[2];
+    int is_polling;
+    int update_cnt;
+    int event_cnt;
+};
+
+/**
+ * The test only creates one block of this plugin.
+ */
+static struct state *last_state;
+
+int test_plugin_get_write_fd()
+{
+    return last_state->pipefd[1];
+}
+int test_plugin_get_event_cnt()
+{
+    return last_state->event_cnt;
+}
+
+static void on_readable(int fd, enum swaystatus_event events, void *data)
+{
+    struct state *state = data;
+
+    char c;
+    if (events == swaystatus_read_ready && read(fd, &c, 1) == 1)
+        ++state->event_cnt;
+
+    /* Only the first event is wanted */
+    state->host->cancel_polling(fd);
+    state->is_polling = 0;
+    state->host->request_update(state->module);
+}
+
+static void* init(const struct swaystatus_plugin_host *host, void *module, const char *config)
+{
+    (void) config;
+
+    if (host->abi_version != SWAYSTATUS_PLUGIN_ABI_VERSION)
+        return NULL;
+
+    struct state *state = calloc(1, sizeof(struct state));
+    if (state == NULL)
+        return NULL;
+    if (pipe(state->pipefd) < 0) {
+        free(state);
+        return NULL;
+    }
+
+    state->host = host;
+    state->module = module;
+    host->request_polling(state->pipefd[0], swaystatus_read_ready, on_readable, state);
+    state->is_polling = 1;
+
+    last_state = state;
+    return state;
+}
+static void update(void *state)
+{
+    ++((struct state*) state)->update_cnt;
+}
+#ifndef NO_RENDER
+/**
+ * Print format followed by the update count in quotes, which commit_print_buffer escapes.
+ */
+static void render(void *state_arg, const char *format)
+{
+    struct state *state = state_arg;
+
+    size_t len = strlen(format);
+    char *buffer = state->host->reserve_print_buffer(len + 32);
+
+    memcpy(buffer, format, len);
+    len += snprintf(buffer + len, 32, " \"%d\"", state->update_cnt);
+
+    state->host->commit_print_buffer(len);
+}
+#endif
+static void fini(void *state_arg)
+{
+    struct state *state = state_arg;
+
+    if (state->is_polling)
+        state->host->cancel_polling(state->pipefd[0]);
+    close(state->pipefd[0]);
+    close(state->pipefd[1]);
+    free(state);
+}
+
+const struct swaystatus_plugin swaystatus_plugin = {
+    .abi_version = ABI_VERSION,
+    .flags = 0,
+
+    .init = init,
+    .update = update,
+#ifndef NO_RENDER
+    .render = render,
+#endif
+    .fini = fini,
+};
@@ -11,7 +11,7 @@ int main()
 {
     {
         char *path = realpath_checked("test_dir");
-        setup_dlpath(path);
+        setup_dlpath(path, false);
         std::free(path);
     }
 
@@ -23,5 +23,9 @@ int main()
     assert((CFunction<int>{"libtest_lib2.so", "f1"}()) == 1);
     assert((CFunction<int, int&>{"libtest_lib2.so", "f2"}(val)) == val);
 
+    // Each library is only opened once
+    assert(dload_library("libtest_lib.so") == dload_library("libtest_lib.so"));
+    assert(dload_library("libtest_lib.so") != dload_library("libtest_lib2.so"));
+
     return 0;
 }
@@ -0,0 +1,122 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+
+#include <string>
+
+#include "../../../src/poller.h"
+#include "../../../src/process_configuration.h"
+#include "../../../src/formatting/printer.hpp"
+#include "../../../src/Callback/dynlib.hpp"
+#include "../../../src/modules/PluginPrinter.hpp"
+
+using namespace swaystatus;
+using swaystatus::modules::makePluginPrinter;
+
+static const char config_path[] = "test_plugin.json";
+
+static const char config_str[] = R"({
+    "plugin":    {"path": "libtest_plugin.so", "format": "up"},
+    "bad_abi":   {"path": "libtest_plugin_bad_abi.so"},
+    "no_render": {"path": "libtest_plugin_no_render.so"}
+})";
+
+/**
+ * Run makePluginPrinter in a child process, which must exit with 1.
+ *
+ * @return stderr of the child
+ */
+static auto make_rejected_plugin(void *module_config) -> std::string
+{
+    int pipefd[2];
+    if (pipe(pipefd) < 0)
+        std::abort();
+
+    pid_t pid = fork();
+    if (pid < 0)
+        std::abort();
+    if (pid == 0) {
+        dup2(pipefd[1], 2);
+        makePluginPrinter(module_config);
+        _exit(0);
+    }
+    close(pipefd[1]);
+
+    std::string output;
+    char buffer[256];
+    for (ssize_t cnt; (cnt = read(pipefd[0], buffer, sizeof(buffer))) > 0; )
+        output.append(buffer, cnt);
+    close(pipefd[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 1);
+
+    return output;
+}
+
+static auto take_output() -> std::string
+{
+    std::string output;
+    take_buffer(output);
+    return output;
+}
+
+int main()
+{
+    setup_dlpath(nullptr, false);
+    init_poller();
+
+    FILE *file = std::fopen(config_path, "w");
+    std::fputs(config_str, file);
+    std::fclose(file);
+
+    void *config = load_config(config_path);
+    std::remove(config_path);
+
+    auto output = make_rejected_plugin(get_module_config(config, "bad_abi"));
+    assert(output.find("Incompatible ABI version") != std::string::npos);
+
+    output = make_rejected_plugin(get_module_config(config, "no_render"));
+    assert(output.find("Missing init, update or render") != std::string::npos);
+
+    auto printer = makePluginPrinter(get_module_config(config, "plugin"));
+    assert(printer);
+
+    // render goes through reserve_print_buffer/commit_print_buffer, which escapes quotes
+    printer->update_and_print();
+    assert(take_output().find(R"("full_text":"up \"1\"",)") != std::string::npos);
+
+    auto get_write_fd = reinterpret_cast<int (*)()>(
+        dload_symbol("libtest_plugin.so", "test_plugin_get_write_fd")
+    );
+    auto get_event_cnt = reinterpret_cast<int (*)()>(
+        dload_symbol("libtest_plugin.so", "test_plugin_get_event_cnt")
+    );
+
+    // The callback cancels polling of its fd and requests an update
+    ssize_t cnt = write(get_write_fd(), "x", 1);
+    assert(cnt == 1);
+    perform_polling(1000);
+    assert(get_event_cnt() == 1);
+
+    cnt = write(get_write_fd(), "x", 1);
+    assert(cnt == 1);
+    perform_polling(0);
+    assert(get_event_cnt() == 1);
+
+    printer->update_and_print(false);
+    assert(take_output().find(R"("full_text":"up \"2\"",)") != std::string::npos);
+
+    // No update is requested this time
+    printer->update_and_print(false);
+    assert(take_output().find(R"("full_text":"up \"2\"",)") != std::string::npos);
+
+    printer.reset();
+    free_config(config);
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+
+#include <string>
+
+#include "../../../src/process_table.hpp"
+
+using namespace swaystatus;
+
+static void write_stat(const std::string &proc, int pid, std::uint64_t utime, std::uint64_t rss)
+{
+    auto dir = proc + "/" + std::to_string(pid);
+    mkdir(dir.c_str(), 0755);
+
+    auto path = dir + "/stat";
+    FILE *file = std::fopen(path.c_str(), "w");
+    assert(file);
+    // comm contains ' ' and ')' to make sure the last ')' is used.
+    std::fprintf(file,
+                 "%d (proc %d) x) S 1 %d %d 0 -1 4194560 100 0 0 0 %lu 5 0 0 20 0 1 0 100 "
+                 "12345678 %lu 18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 17 3 0 0 0 0 0\n",
+                 pid, pid, pid, pid, static_cast<unsigned long>(utime),
+                 static_cast<unsigned long>(rss));
+    std::fclose(file);
+}
+static void remove_process(const std::string &proc, int pid)
+{
+    auto dir = proc + "/" + std::to_string(pid);
+    unlink((dir + "/stat").c_str());
+    rmdir(dir.c_str());
+}
+
+static std::uint64_t get_timestamp()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::uint64_t>(ts.tv_sec) * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+int main()
+{
+    constexpr const int process_cnt = 5000;
+    constexpr const std::size_t top_n = 5;
+
+    char tmpl[] = "/tmp/test_process_table.XXXXXX";
+    char *dir = mkdtemp(tmpl);
+    assert(dir);
+    (void) dir;
+    const std::string proc = tmpl;
+
+    for (int pid = 1; pid <= process_cnt; ++pid)
+        write_stat(proc, pid, 100, pid);
+    // Entries that are not pids must be ignored
+    mkdir((proc + "/sys").c_str(), 0755);
+    std::fclose(std::fopen((proc + "/meminfo").c_str(), "w"));
+
+    std::string comm;
+    std::uint64_t cpu_ticks, rss_pages;
+    const char stat[] = "42 (a) b) R 1 2 3 4 5 6 7 8 9 10 30 12 13 14 15 16 17 18 19 20 77 22\n";
+    assert(parse_pid_stat(stat, sizeof(stat) - 1, comm, cpu_ticks, rss_pages));
+    assert(comm == "a) b");
+    assert(cpu_ticks == 30 + 12);
+    assert(rss_pages == 77);
+
+    ProcessTable table{top_n, process_sort_key::cpu, proc.c_str()};
+    table.update();
+    assert(table.get_process_count() == process_cnt);
+
+    // Make some processes busy and kill some others
+    for (int pid = 1000; pid != 1000 + 2 * top_n; ++pid)
+        write_stat(proc, pid, 100 + pid, pid);
+    for (int pid = 2000; pid != 2100; ++pid)
+        remove_process(proc, pid);
+
+    table.update();
+    assert(table.get_process_count() == process_cnt - 100);
+
+    const auto &top = table.get_top();
+    assert(top.size() == top_n);
+    for (std::size_t i = 0; i != top_n; ++i) {
+        assert(top[i]->pid == static_cast<pid_t>(1000 + 2 * top_n - 1 - i));
+        assert(top[i]->comm == "proc " + std::to_string(top[i]->pid) + ") x");
+    }
+
+    ProcessTable mem_table{top_n, process_sort_key::memory, proc.c_str()};
+    mem_table.update();
+    assert(mem_table.get_top()[0]->pid == process_cnt);
+    assert(mem_table.get_top()[0]->rss == process_cnt * static_cast<std::uint64_t>(getpagesize()));
+
+    // Benchmark
+    constexpr const std::size_t iterations = 100;
+
+    const auto begin = get_timestamp();
+    for (std::size_t i = 0; i != iterations; ++i)
+        table.update();
+    const auto elapsed = (get_timestamp() - begin) / iterations;
+
+    std::printf("Updating table of %zu processes takes %lu us on average\n",
+                table.get_process_count(), static_cast<unsigned long>(elapsed / 1000));
+
+    for (int pid = 1; pid <= process_cnt; ++pid)
+        remove_process(proc, pid);
+    rmdir((proc + "/sys").c_str());
+    unlink((proc + "/meminfo").c_str());
+    rmdir(proc.c_str());
+
+    return 0;
+}
@@ -15,7 +15,10 @@ int main()
         char *path = realpath_checked("python3_test_dir");
         setup_pythonpath(path);
 
+        // libpython is only loaded by load_libpython3()
+        assert(!MainInterpreter::has_initialized());
         MainInterpreter::load_libpython3();
+        assert(MainInterpreter::has_initialized());
         std::free(path);
     }
 
@@ -54,6 +57,28 @@ int main()
         assert(identity2(2021) == 2021);
     }
 
+    // The GIL is only acquired by the first acquire() in the batch and released at its end.
+    {
+        Interpreter::Batch_scoped batch;
+
+        for (ssize_t i = 0; i != 3; ++i) {
+            auto scope = MainInterpreter::get().acquire();
+            static_cast<void>(scope);
+
+            Module test{"test"};
+            Callable<ssize_t, ssize_t> identity{test.getattr("identity")};
+            assert(identity(i) == i);
+        }
+    }
+    {
+        auto scope = MainInterpreter::get().acquire();
+        static_cast<void>(scope);
+
+        Module test{"test"};
+        Callable<str, std::string> identity{test.getattr("identity")};
+        assert(identity("Hello").get_view() == "Hello");
+    }
+
     ;
 
     return 0;
@@ -0,0 +1,110 @@
+#include <cassert>
+#include <cstdio>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#define USE_PYTHON
+#include "../../../src/utility.h"
+#include "../../../src/worker_pool.hpp"
+#include "../../../src/Callback/python3.hpp"
+
+using namespace swaystatus;
+using namespace swaystatus::python;
+
+/**
+ * Benchmark CPU-heavy python blocks updated in the worker pool, loaded into the main
+ * interpreter vs. each into its own SubInterpreter.
+ */
+
+static constexpr const std::size_t block_cnt = 4;
+static constexpr const std::size_t iterations = 3;
+
+static constexpr const char *code =
+    "def update():\n"
+    "    return sum(i * i for i in range(2000000)) % 1000\n";
+
+struct Block {
+    Interpreter *interpreter;
+    Callable<ssize_t> update{Object{}};
+    ssize_t result = -1;
+};
+
+static std::atomic<std::size_t> done_cnt;
+
+static void job(void *data)
+{
+    auto *block = static_cast<Block*>(data);
+    {
+        auto scope = block->interpreter->acquire_on_current_thread();
+        block->result = block->update();
+    }
+    done_cnt.fetch_add(1, std::memory_order_release);
+}
+
+static void load(Block &block, Interpreter &interpreter)
+{
+    block.interpreter = &interpreter;
+
+    auto scope = interpreter.acquire();
+    Compiled compiled{"block", code};
+    Module module{"block", compiled};
+    block.update = Callable<ssize_t>{module.getattr("update")};
+}
+
+static auto run(WorkerPool &pool, Block *blocks) -> double
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i != iterations; ++i) {
+        done_cnt.store(0, std::memory_order_relaxed);
+        for (std::size_t j = 0; j != block_cnt; ++j)
+            pool.submit(job, &blocks[j]);
+        while (done_cnt.load(std::memory_order_acquire) != block_cnt)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+int main()
+{
+    setup_pythonpath(nullptr);
+    MainInterpreter::load_libpython3();
+
+    auto *pool = new WorkerPool{block_cnt};
+
+    // Blocks are never freed, since python objects can only be released with the GIL held.
+    auto *shared = new Block[block_cnt];
+    for (std::size_t i = 0; i != block_cnt; ++i)
+        load(shared[i], MainInterpreter::get());
+
+    auto *isolated = new Block[block_cnt];
+    for (std::size_t i = 0; i != block_cnt; ++i) {
+        SubInterpreter *interpreter;
+        {
+            auto scope = MainInterpreter::get().acquire();
+            // Never freed, just like in swaystatus.
+            interpreter = new SubInterpreter{};
+        }
+        load(isolated[i], *interpreter);
+    }
+
+    double shared_time = run(*pool, shared);
+    double isolated_time = run(*pool, isolated);
+
+    for (std::size_t i = 0; i != block_cnt; ++i) {
+        assert(shared[i].result >= 0);
+        assert(shared[i].result == isolated[i].result);
+    }
+
+    std::printf("%zu blocks x %zu updates, own GIL: %s\n",
+                block_cnt, iterations, SubInterpreter::has_own_gil() ? "yes" : "no");
+    std::printf("main interpreter: %.3fs\n", shared_time);
+    std::printf("subinterpreters:  %.3fs\n", isolated_time);
+    std::printf("speed-up: %.2fx\n", shared_time / isolated_time);
+
+    return 0;
+}
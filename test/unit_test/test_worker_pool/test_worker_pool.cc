@@ -0,0 +1,74 @@
+#include <poll.h>
+
+#include <cassert>
+#include <cstdio>
+
+#include <atomic>
+#include <string>
+
+#include "../../../src/worker_pool.hpp"
+#include "../../../src/TripleBuffer.hpp"
+
+using namespace swaystatus;
+
+struct Snapshot {
+    std::string text;
+    int seq = 0;
+};
+
+static WorkerPool *pool;
+static TripleBuffer<Snapshot> snapshots;
+static std::atomic<bool> is_busy{false};
+static int produced = 0;
+
+static void job(void *data)
+{
+    (void) data;
+
+    auto &snapshot = snapshots.get_back();
+    ++produced;
+    snapshot.text = "snapshot " + std::to_string(produced);
+    snapshot.seq = produced;
+    snapshots.publish();
+
+    is_busy.store(false, std::memory_order_release);
+    pool->notify();
+}
+
+int main()
+{
+    constexpr const int job_cnt = 10000;
+
+    pool = new WorkerPool{2};
+
+    assert(!snapshots.update_front());
+    assert(snapshots.get_front().seq == 0);
+
+    int submitted = 0, last_seq = 0;
+    while (last_seq != job_cnt) {
+        if (submitted != job_cnt && !is_busy.load(std::memory_order_acquire)) {
+            is_busy.store(true, std::memory_order_relaxed);
+            pool->submit(job, nullptr);
+            ++submitted;
+        }
+
+        struct pollfd pfd{pool->get_notification_fd(), POLLIN, 0};
+        if (poll(&pfd, 1, 1000) == 1)
+            pool->consume_notification();
+
+        if (snapshots.update_front()) {
+            const auto &snapshot = snapshots.get_front();
+            // Snapshots must be complete and never go backwards.
+            assert(snapshot.seq > last_seq);
+            assert(snapshot.text == "snapshot " + std::to_string(snapshot.seq));
+            last_seq = snapshot.seq;
+        }
+    }
+
+    assert(!snapshots.update_front());
+    assert(snapshots.get_front().seq == job_cnt);
+
+    std::puts("test_worker_pool passed");
+
+    return 0;
+}